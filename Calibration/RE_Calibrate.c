@@ -0,0 +1,159 @@
+/*
+Vassar Cognitive Science - Robot Ethology IR Calibration
+
+This program measures both IR sensors of one robot at a set of known distances and writes them to the calibration
+file that the engine loads at startup (see RE_Calibration.h).  Robots are wired differently (the GUI robot has its
+IR sensors on analog ports 0 and 1, the Plain and Template robots on 2 and 3), so the first screen asks which ports
+they are on and shows what each port reads.  Then put a flat, light-colored board in front of the robot at each
+distance the screen asks for and press A, or press B to skip that distance.
+
+Course:			211 - Perception & Action
+Instructors:	Ken Livingston, Joshua de Leeuw
+*/
+
+// *** Import Libraries *** //
+
+#include <kipr/wombat.h>	 // KIPR Wombat native library
+#include "RE_Engine.h"		 // the shared Robot Ethology engine: sensors, actions, behaviors and the hierarchy
+#include "RE_Calibration.h" // turning IR readings into distances
+
+// *** Define PIN Address *** //
+
+#define ANALOG_PORTS 6 // the Wombat's analog ports, 0 to 5
+
+int right_ir_pin = -1; // chosen on the first screen; -1 until then
+int left_ir_pin = -1;
+
+// *** Calibration Settings *** //
+
+#define CALIBRATION_SAMPLES 64 // readings averaged for each sensor at each distance
+
+const int calibration_distances_mm[] = {50, 75, 100, 150, 200, 250, 300, 400, 500, 600, 800};
+#define CALIBRATION_DISTANCE_COUNT (int)(sizeof(calibration_distances_mm) / sizeof(calibration_distances_mm[0]))
+
+// *** Function Definitions *** //
+
+/* READ BOTH IR SENSORS MANY TIMES, ALTERNATING SO THEY SEE THE SAME MOMENT, AND STORE THE ROUNDED MEANS */
+void measure_ir(calibration_point* point)
+{
+	long right_sum = 0, left_sum = 0;
+	int i;
+	for (i = 0; i < CALIBRATION_SAMPLES; i++)
+	{
+		right_sum += analog_et(right_ir_pin);
+		left_sum += analog_et(left_ir_pin);
+		msleep(5);
+	}
+	point->right_ir = (int)((right_sum + CALIBRATION_SAMPLES / 2) / CALIBRATION_SAMPLES);
+	point->left_ir = (int)((left_sum + CALIBRATION_SAMPLES / 2) / CALIBRATION_SAMPLES);
+}
+
+/* WAIT FOR A (RETURNS TRUE) OR B (RETURNS FALSE) TO BE PRESSED AND RELEASED */
+bool wait_for_answer()
+{
+	while (!a_button() && !b_button())
+		msleep(10);
+	bool accepted = a_button();
+	while (a_button() || b_button())
+		msleep(10);
+	return accepted;
+}
+
+/* WAIT FOR A BUTTON TO BE RELEASED */
+void wait_for_release(int (*button)())
+{
+	while (button())
+		msleep(10);
+}
+
+/* LET THE USER PICK THE PORTS OF BOTH IR SENSORS, SHOWING WHAT EACH READS, UNTIL BOTH ARE SET AND C IS PRESSED */
+void choose_ir_pins()
+{
+	set_a_button_text("Right IR");
+	set_b_button_text("Left IR");
+	set_c_button_text("Start");
+	console_clear();
+	display_printf(0, 0, "Which ports are the IR sensors on?");
+	display_printf(0, 1, "(hold a hand in front to check)");
+	while (true)
+	{
+		if (right_ir_pin >= 0)
+			display_printf(0, 3, "A: right IR on port %d, reads %4d", right_ir_pin, analog_et(right_ir_pin));
+		else
+			display_printf(0, 3, "A: right IR not set             ");
+		if (left_ir_pin >= 0)
+			display_printf(0, 4, "B: left IR on port %d, reads %4d ", left_ir_pin, analog_et(left_ir_pin));
+		else
+			display_printf(0, 4, "B: left IR not set              ");
+		bool ready = right_ir_pin >= 0 && left_ir_pin >= 0 && right_ir_pin != left_ir_pin;
+		display_printf(0, 6, ready ? "C: start calibrating          " : "C: start (set two ports first)");
+
+		if (a_button())
+		{
+			right_ir_pin = (right_ir_pin + 1) % ANALOG_PORTS;
+			wait_for_release(a_button);
+		}
+		else if (b_button())
+		{
+			left_ir_pin = (left_ir_pin + 1) % ANALOG_PORTS;
+			wait_for_release(b_button);
+		}
+		else if (c_button())
+		{
+			wait_for_release(c_button);
+			if (ready)
+				break;
+		}
+		msleep(50);
+	}
+	set_c_button_text("");
+}
+
+//==================================//
+//===============MAIN===============//
+//==================================//
+
+int main()
+{
+	calibration_point points[MAX_CALIBRATION_POINTS];
+	int count = 0;
+
+	choose_ir_pins(); // the calibration is only as good as the ports it reads
+	set_a_button_text("Measure");
+	set_b_button_text("Skip");
+
+	int i;
+	for (i = 0; i < CALIBRATION_DISTANCE_COUNT && count < MAX_CALIBRATION_POINTS; i++)
+	{
+		console_clear();
+		display_printf(0, 0, "IR calibration (%d of %d)", i + 1, CALIBRATION_DISTANCE_COUNT);
+		display_printf(0, 2, "Put the board %d mm in front", calibration_distances_mm[i]);
+		display_printf(0, 3, "of both IR sensors.");
+		display_printf(0, 5, "A: measure    B: skip");
+		if (!wait_for_answer())
+			continue;
+
+		display_printf(0, 7, "Measuring...");
+		points[count].distance_mm = calibration_distances_mm[i];
+		measure_ir(&points[count]);
+		printf("%d mm: right %d left %d\n", points[count].distance_mm, points[count].right_ir, points[count].left_ir);
+		count++;
+	}
+
+	console_clear();
+	if (!build_ir_tables(points, count))
+	{ // fewer than two points, or a sensor whose readings don't fall as the board moves away
+		display_printf(0, 0, "Calibration failed: the readings");
+		display_printf(0, 1, "must fall as the distance grows.");
+		return 1;
+	}
+	if (!save_ir_calibration(IR_CALIBRATION_PATH, points, count))
+	{
+		display_printf(0, 0, "Could not write %s", IR_CALIBRATION_PATH);
+		return 1;
+	}
+
+	display_printf(0, 0, "Saved %d distances to", count);
+	display_printf(0, 1, "%s", IR_CALIBRATION_PATH);
+	return 0;
+}
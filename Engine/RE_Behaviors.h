@@ -0,0 +1,83 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (behavior definitions)
+
+Every behavior is defined once, in RE_BEHAVIORS below, as:
+
+	BEHAVIOR(name, title, fires, mirrored, left, right, seconds)
+
+[name] is the behavior's type without _TYPE, [fires] and [mirrored] are expressions over the condition bits in
+"conditions" (see RE_Engine.h), and left/right/seconds are the default action speeds for the unmirrored case.
+
+The engine expands this list into the behavior registry and plan_behavior() for the runtime hierarchy used by the
+GUI program.  A program whose hierarchy never changes can instead list its behaviors in a macro and get a decision
+function with the hierarchy compiled in, top to bottom, with no table or hierarchy walk at runtime:
+
+	#define MY_HIERARCHY(STEP) STEP(ESCAPE_F) STEP(AVOID) STEP(CRUISE_S)
+	DEFINE_FIXED_DECIDER(decide, MY_HIERARCHY)
+
+	decision winner;
+	decide(sense_conditions(), &winner);
+*/
+
+#ifndef RE_BEHAVIORS_H
+#define RE_BEHAVIORS_H
+
+#include "RE_Engine.h"
+
+#define RE_BEHAVIORS(BEHAVIOR)                                                                                                                                                       \
+	BEHAVIOR(SEEK_LIGHT, "SEEK LIGHT", (conditions & PHOTO_BIT) != 0, (conditions & RIGHT_DARKER_BIT) == 0, -0.2, 0.2, 0.25)                                                       \
+	BEHAVIOR(SEEK_DARK, "SEEK DARK", (conditions & PHOTO_BIT) != 0, (conditions & RIGHT_DARKER_BIT) == 0, 0.2, -0.2, 0.25)                                                         \
+	BEHAVIOR(APPROACH, "APPROACH", ((conditions & LEFT_APPROACH_BIT) != 0) != ((conditions & RIGHT_APPROACH_BIT) != 0), (conditions & LEFT_APPROACH_BIT) == 0, 0.1, 0.9, 0.5) \
+	BEHAVIOR(AVOID, "AVOID", ((conditions & LEFT_AVOID_BIT) != 0) != ((conditions & RIGHT_AVOID_BIT) != 0), (conditions & LEFT_AVOID_BIT) == 0, 0.5, -0.5, 0.1)               \
+	BEHAVIOR(ESCAPE_F, "ESCAPE FRONT", (conditions & FRONT_BUMP_BIT) != 0, false, -0.2, -0.9, 3)                                                                                \
+	BEHAVIOR(ESCAPE_B, "ESCAPE BACK", (conditions & BACK_BUMP_BIT) != 0, false, 0.9, 0.9, 1)                                                                                   \
+	BEHAVIOR(CRUISE_S, "CRUISE STRAIGHT", true, false, 0.50, 0.50, 0.5)                                                                                                         \
+	BEHAVIOR(CRUISE_A, "CRUISE ARC", true, false, 0.25, 0.4, 0.5)
+
+// For every behavior, NAME_fires(conditions) and NAME_mirrored(conditions) evaluate its two expressions
+#define RE_BEHAVIOR_TESTS(name, title, fires, mirrored, left, right, seconds) \
+	static inline bool name##_fires(int conditions)                          \
+	{                                                                        \
+		(void)conditions;                                                    \
+		return fires;                                                        \
+	}                                                                        \
+	static inline bool name##_mirrored(int conditions)                       \
+	{                                                                        \
+		(void)conditions;                                                    \
+		return mirrored;                                                     \
+	}
+RE_BEHAVIORS(RE_BEHAVIOR_TESTS)
+
+/* FILL IN A DECISION FROM THE SPEEDS OF ONE BEHAVIOR */
+static inline void fill_decision_from(action_params params, int type, bool mirrored, decision* out)
+{
+	out->type = type;
+	out->params.left = mirrored ? params.right : params.left;
+	out->params.right = mirrored ? params.left : params.right;
+	out->params.seconds = params.seconds;
+}
+
+/* FILL IN A DECISION FROM THE REGISTRY SPEEDS OF ONE BEHAVIOR */
+static inline void fill_decision(int type, bool mirrored, decision* out)
+{
+	fill_decision_from(behavior_registry[type].params, type, mirrored, out);
+}
+
+// One step of a fixed hierarchy: if this behavior fires, it wins
+#define FIXED_DECIDER_STEP(name)                                      \
+	if (name##_fires(conditions))                                     \
+	{                                                                 \
+		fill_decision(name##_TYPE, name##_mirrored(conditions), out); \
+		return;                                                       \
+	}
+
+// Define a decision function named [function] for the fixed hierarchy [HIERARCHY]; if nothing fires, it stops
+#define DEFINE_FIXED_DECIDER(function, HIERARCHY)                    \
+	static inline void function(int conditions, decision* out)       \
+	{                                                                \
+		HIERARCHY(FIXED_DECIDER_STEP)                                \
+		out->type = NO_BEHAVIOR_TYPE;                                \
+		out->params = stop_params;                                   \
+	}
+
+#endif
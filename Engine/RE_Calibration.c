@@ -0,0 +1,123 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (IR distance calibration)
+
+See RE_Calibration.h for the file format and how the tables are used.
+
+Course:			211 - Perception & Action
+Instructors:	Ken Livingston, Joshua de Leeuw
+*/
+
+#include "RE_Calibration.h"
+
+bool ir_calibrated = false;
+
+static short right_table[LINEARIZE_ENTRIES]; // distance in mm for the reading (entry << LINEARIZE_SHIFT)
+static short left_table[LINEARIZE_ENTRIES];
+
+/* WORK OUT THE DISTANCE FOR ONE READING FROM THE CALIBRATION POINTS OF ONE SENSOR (SORTED BY FALLING READING) */
+static int interpolate_points(const int* readings, const int* distances, int count, int raw)
+{
+	if (raw >= readings[0])
+		return distances[0]; // closer than the closest point we measured
+	int i;
+	for (i = 1; i < count; i++)
+	{
+		if (raw >= readings[i])
+		{ // between point i - 1 and point i
+			int span = readings[i - 1] - readings[i];
+			return distances[i] + (distances[i - 1] - distances[i]) * (raw - readings[i]) / span;
+		}
+	}
+	return distances[count - 1]; // farther than the farthest point we measured
+}
+
+/* FILL ONE SENSOR'S LOOKUP TABLE, RETURNS FALSE IF ITS READINGS DON'T FALL AS THE DISTANCE GROWS */
+static bool build_table(short* table, const int* readings, const int* distances, int count)
+{
+	int i;
+	for (i = 1; i < count; i++)
+	{
+		if (readings[i] >= readings[i - 1] || distances[i] <= distances[i - 1])
+			return false;
+	}
+	for (i = 0; i < LINEARIZE_ENTRIES; i++)
+		table[i] = (short)interpolate_points(readings, distances, count, i << LINEARIZE_SHIFT);
+	return true;
+}
+
+bool build_ir_tables(const calibration_point* points, int count)
+{
+	if (count < 2 || count > MAX_CALIBRATION_POINTS)
+		return false;
+
+	int distances[MAX_CALIBRATION_POINTS], right[MAX_CALIBRATION_POINTS], left[MAX_CALIBRATION_POINTS];
+	int i, j;
+	for (i = 0; i < count; i++)
+	{ // sort by distance, nearest first, so the readings should be falling
+		calibration_point point = points[i];
+		for (j = i; j > 0 && distances[j - 1] > point.distance_mm; j--)
+		{
+			distances[j] = distances[j - 1];
+			right[j] = right[j - 1];
+			left[j] = left[j - 1];
+		}
+		distances[j] = point.distance_mm;
+		right[j] = point.right_ir;
+		left[j] = point.left_ir;
+	}
+
+	ir_calibrated = build_table(right_table, right, distances, count) && build_table(left_table, left, distances, count);
+	return ir_calibrated;
+}
+
+bool load_ir_calibration(const char* path)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL)
+		return false;
+
+	calibration_point points[MAX_CALIBRATION_POINTS];
+	int count = 0;
+	char line[128];
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		calibration_point point;
+		if (line[0] == '#')
+			continue;
+		if (sscanf(line, "%d %d %d", &point.distance_mm, &point.right_ir, &point.left_ir) == 3 && count < MAX_CALIBRATION_POINTS)
+			points[count++] = point;
+	}
+	fclose(file);
+
+	if (!build_ir_tables(points, count))
+	{
+		printf("%s: the readings must fall as the distance grows, ignoring the calibration\n", path);
+		return false;
+	}
+	return true;
+}
+
+bool save_ir_calibration(const char* path, const calibration_point* points, int count)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+		return false;
+	fprintf(file, "# distance_mm right_ir left_ir\n");
+	int i;
+	for (i = 0; i < count; i++)
+		fprintf(file, "%d %d %d\n", points[i].distance_mm, points[i].right_ir, points[i].left_ir);
+	fclose(file);
+	return true;
+}
+
+int ir_to_mm(int channel, int raw)
+{
+	const short* table = (channel == RIGHT_IR_CHANNEL) ? right_table : left_table;
+	if (raw < 0)
+		raw = 0;
+	if (raw > ANALOG_MAX)
+		raw = ANALOG_MAX;
+	int entry = raw >> LINEARIZE_SHIFT;
+	int fraction = raw & ((1 << LINEARIZE_SHIFT) - 1);
+	return table[entry] + (table[entry + 1] - table[entry]) * fraction / (1 << LINEARIZE_SHIFT); // the product is negative where the distance falls, so divide instead of shifting
+}
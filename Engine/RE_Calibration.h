@@ -0,0 +1,43 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (IR distance calibration)
+
+An IR reading is not a distance: the value rises steeply as things come close, and every sensor is a little
+different.  The calibration program (Calibration/RE_Calibrate.c) measures both IR sensors of one robot at a set of
+known distances and writes them to IR_CALIBRATION_PATH, one line per distance:
+
+	# distance_mm right_ir left_ir
+	100 2710 2655
+	200 1720 1690
+
+start_engine() loads that file if it exists and turns it into one lookup table per sensor, so converting a reading
+to millimeters at runtime is a table lookup and a whole-number interpolation.  read_sensors() then keeps
+right_ir_mm and left_ir_mm up to date, and avoid_distance_mm / approach_distance_mm (when set above zero) replace
+avoid_threshold / approach_threshold with distances that mean the same on every robot.
+*/
+
+#ifndef RE_CALIBRATION_H
+#define RE_CALIBRATION_H
+
+#include "RE_Engine.h"
+
+#define IR_CALIBRATION_PATH "ir_calibration.txt"
+#define MAX_CALIBRATION_POINTS 16
+#define ANALOG_MAX 4095		   // the largest reading analog_et can return
+#define LINEARIZE_SHIFT 4	   // the lookup table has one entry every 2^LINEARIZE_SHIFT counts of the reading
+#define LINEARIZE_ENTRIES ((ANALOG_MAX >> LINEARIZE_SHIFT) + 2)
+
+typedef struct calibration_point
+{
+	int distance_mm;
+	int right_ir; // the reading of each sensor at that distance
+	int left_ir;
+} calibration_point;
+
+extern bool ir_calibrated; // true once a calibration has been loaded
+
+bool load_ir_calibration(const char* path);											// read a calibration file and build the lookup tables, returns false if it is missing or unusable
+bool save_ir_calibration(const char* path, const calibration_point* points, int count); // write a calibration file
+bool build_ir_tables(const calibration_point* points, int count);					// build the lookup tables from calibration points, returns false if they are unusable
+int ir_to_mm(int channel, int raw);													// the distance in mm for a reading of RIGHT_IR_CHANNEL or LEFT_IR_CHANNEL
+
+#endif
@@ -0,0 +1,351 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (configuration file)
+
+See RE_Config.h for the file format.
+
+Course:			211 - Perception & Action
+Instructors:	Ken Livingston, Joshua de Leeuw
+*/
+
+#include "RE_Config.h"
+#include "RE_Sampling.h"
+#include <string.h>	   // library for comparing configuration keys
+#include <stdatomic.h> // library for handing a new configuration to the main loop without locking
+#include <pthread.h>   // library for the configuration watcher thread
+#include <sys/stat.h>  // library for checking whether the configuration file changed
+#include <unistd.h>	   // library for sleeping in the configuration watcher
+
+static robot_config default_config;								// the compiled-in values, which every parse starts from
+static _Atomic(robot_config*) pending_config = NULL;			// a parsed configuration waiting for the main loop to pick it up
+static _Atomic(telemetry_link*) retired_link = NULL;			// a telemetry link the main loop stopped using, for the watcher to close
+static char prepared_target[TELEMETRY_TARGET_LENGTH] = "off";	// the telemetry target of the last prepared configuration
+
+/* FIND A BEHAVIOR TYPE BY ITS TITLE, WITH UNDERSCORES STANDING IN FOR SPACES, RETURNS -1 IF THERE IS NONE */
+int find_behavior_type(const char* name)
+{
+	int type;
+	for (type = 0; type < BEHAVIOR_TYPE_COUNT; type++)
+	{
+		const char* title = behavior_registry[type].title;
+		size_t j = 0;
+		while (title[j] != '\0' && (title[j] == name[j] || (title[j] == ' ' && name[j] == '_')))
+			j++;
+		if (title[j] == '\0' && name[j] == '\0')
+			return type;
+	}
+	return -1;
+}
+
+/* READ THE NEXT WORD ON THE LINE AS A NUMBER, RETURNS FALSE IF IT IS MISSING OR NOT A NUMBER */
+static bool parse_number(char** rest, float* value)
+{
+	char* word = strtok_r(NULL, " \t\r\n", rest);
+	char* end;
+	if (word == NULL)
+		return false;
+	*value = strtof(word, &end);
+	return *end == '\0';
+}
+
+/* PARSE THE CONFIGURATION FILE ON TOP OF THE DEFAULTS, RETURNS FALSE IF THE FILE IS MISSING OR HAS AN ERROR */
+bool parse_config(const char* path, robot_config* config)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL)
+		return false;
+
+	*config = default_config;
+
+	char line[256];
+	int line_number = 0;
+	bool ok = true;
+	while (ok && fgets(line, sizeof(line), file) != NULL)
+	{
+		line_number++;
+		char* comment = strchr(line, '#');
+		if (comment != NULL)
+			*comment = '\0'; // ignore everything after a #
+
+		char* rest;
+		char* key = strtok_r(line, " \t\r\n", &rest);
+		float value;
+		if (key == NULL)
+			continue; // empty line
+
+		if (strcmp(key, "avoid_threshold") == 0 && (ok = parse_number(&rest, &value)))
+			config->avoid_threshold = (int)value;
+		else if (strcmp(key, "approach_threshold") == 0 && (ok = parse_number(&rest, &value)))
+			config->approach_threshold = (int)value;
+		else if (strcmp(key, "photo_threshold") == 0 && (ok = parse_number(&rest, &value)))
+			config->photo_threshold = (int)value;
+		else if (strcmp(key, "avoid_distance_cm") == 0 && (ok = parse_number(&rest, &value)))
+			config->avoid_distance_mm = (int)(value * 10);
+		else if (strcmp(key, "approach_distance_cm") == 0 && (ok = parse_number(&rest, &value)))
+			config->approach_distance_mm = (int)(value * 10);
+		else if (strcmp(key, "hierarchy") == 0)
+		{
+			size_t i;
+			for (i = 0; i < BEHAVIOR_TYPE_COUNT; i++)
+				config->hierarchy[i].is_active = false; // only the listed behaviors are active
+
+			int rank = 0;
+			char* name;
+			while (ok && (name = strtok_r(NULL, " \t\r\n", &rest)) != NULL)
+			{
+				int type = find_behavior_type(name);
+				ok = type >= 0;
+				for (i = 0; ok && i < BEHAVIOR_TYPE_COUNT; i++)
+				{
+					if (config->hierarchy[i].type == type)
+					{
+						config->hierarchy[i].is_active = true;
+						config->hierarchy[i].rank = rank++;
+					}
+				}
+			}
+			sort_hierarchy(config->hierarchy, BEHAVIOR_TYPE_COUNT);
+			config->has_hierarchy = true;
+		}
+		else if (strcmp(key, "filter") == 0)
+		{
+			char* channel_name = strtok_r(NULL, " \t\r\n", &rest);
+			char* kind_name = strtok_r(NULL, " \t\r\n", &rest);
+			filter_setting setting = {-1, 0};
+			int channel, kind;
+			for (kind = 0; kind_name != NULL && kind < FILTER_KIND_COUNT; kind++)
+			{
+				if (strcmp(kind_name, filter_kind_names[kind]) == 0)
+					setting.kind = kind;
+			}
+			if (setting.kind > FILTER_NONE)
+				ok = parse_number(&rest, &value) && (setting.parameter = (int)value) > 0;
+			else
+				ok = setting.kind == FILTER_NONE;
+
+			sensor_filter check; // only used to validate the setting
+			ok = ok && channel_name != NULL && set_filter(&check, setting);
+			bool found = false;
+			for (channel = 0; ok && channel < ANALOG_CHANNEL_COUNT; channel++)
+			{
+				if (strcmp(channel_name, "ALL") == 0 || strcmp(channel_name, analog_channel_names[channel]) == 0)
+				{
+					config->filters[channel] = setting;
+					found = true;
+				}
+			}
+			ok = ok && found;
+		}
+		else if (strcmp(key, "sampling") == 0)
+		{
+			char* mode = strtok_r(NULL, " \t\r\n", &rest);
+			ok = mode != NULL && (strcmp(mode, "adaptive") == 0 || strcmp(mode, "every_pass") == 0);
+			if (ok)
+				config->adaptive_sampling = strcmp(mode, "adaptive") == 0;
+		}
+		else if (strcmp(key, "oversampling") == 0 && (ok = parse_number(&rest, &value)))
+		{
+			config->oversampling = (int)value;
+			ok = value == 1 || value == 4 || value == 16 || value == 64;
+		}
+		else if (strcmp(key, "session_log") == 0)
+		{
+			char* setting = strtok_r(NULL, " \t\r\n", &rest);
+			ok = setting != NULL && (strcmp(setting, "on") == 0 || strcmp(setting, "off") == 0);
+			if (ok)
+				config->session_log = strcmp(setting, "on") == 0;
+		}
+		else if (strcmp(key, "telemetry") == 0)
+		{
+			char* target = strtok_r(NULL, " \t\r\n", &rest);
+			ok = target != NULL && strlen(target) < TELEMETRY_TARGET_LENGTH;
+			if (ok)
+				strcpy(config->telemetry, target);
+		}
+		else if (strcmp(key, "action") == 0)
+		{
+			char* name = strtok_r(NULL, " \t\r\n", &rest);
+			int type = (name != NULL) ? find_behavior_type(name) : -1;
+			action_params params;
+			ok = type >= 0 && parse_number(&rest, &params.left) && parse_number(&rest, &params.right) && parse_number(&rest, &params.seconds);
+			if (ok)
+				config->actions[type] = params;
+		}
+		else if (ok)
+		{
+			ok = false; // unknown key
+		}
+	}
+	fclose(file);
+
+	if (!ok)
+		printf("%s line %d: not understood, keeping the previous settings\n", path, line_number);
+	return ok;
+}
+
+/* DO THE SLOW PART OF APPLYING A CONFIGURATION BEFORE IT REACHES THE MAIN LOOP: THE DECISION TABLE AND THE SOCKET */
+static void prepare_config(robot_config* config)
+{
+	build_decision_table(config->hierarchy, BEHAVIOR_TYPE_COUNT, config->actions, config->table); // the registry is the main loop's, so the speeds come from the configuration
+
+	config->telemetry_changed = strcmp(config->telemetry, prepared_target) != 0;
+	config->telemetry_link = NULL;
+	if (config->telemetry_changed)
+	{ // only reopen the socket when the target changed
+		bool ok;
+		config->telemetry_link = open_telemetry(config->telemetry, &ok);
+		if (!ok)
+			printf("telemetry %s: not understood, telemetry is off\n", config->telemetry);
+		strcpy(prepared_target, config->telemetry);
+	}
+}
+
+/* HAND A PREPARED CONFIGURATION TO THE MAIN LOOP, REPLACING ONE IT HAS NOT PICKED UP YET */
+static void publish_config(const robot_config* config)
+{
+	robot_config* copy = malloc(sizeof(robot_config));
+	if (copy == NULL)
+	{
+		if (config->telemetry_changed)
+			close_telemetry(config->telemetry_link);
+		return;
+	}
+	*copy = *config;
+	robot_config* replaced = atomic_exchange(&pending_config, copy);
+	if (replaced != NULL && replaced->telemetry_changed)
+	{ // the main loop never saw the replaced link: hand it on if the target is still the same, close it otherwise
+		if (copy->telemetry_changed)
+			close_telemetry(replaced->telemetry_link);
+		else
+		{
+			copy->telemetry_changed = true;
+			copy->telemetry_link = replaced->telemetry_link;
+		}
+	}
+	free(replaced);
+}
+
+/* TRUE IF TWO HIERARCHIES HAVE THE SAME ACTIVE BEHAVIORS IN THE SAME ORDER, WHICH IS ALL THE DECISION TABLE DEPENDS ON */
+static bool same_order(const behavior* a, const behavior* b)
+{
+	int i;
+	for (i = 0; i < BEHAVIOR_TYPE_COUNT; i++)
+	{
+		if (a[i].type != b[i].type || a[i].is_active != b[i].is_active)
+			return false;
+	}
+	return true;
+}
+
+/* COPY A WAITING CONFIGURATION INTO THE ENGINE; CALLED BETWEEN DECISIONS SO A DECISION NEVER SEES HALF OF ONE */
+bool apply_pending_config(bool* replaced_hierarchy)
+{
+	robot_config* config = atomic_exchange(&pending_config, NULL);
+	if (config == NULL)
+		return false; // the common case: one atomic read
+
+	avoid_threshold = config->avoid_threshold;
+	approach_threshold = config->approach_threshold;
+	photo_threshold = config->photo_threshold;
+	avoid_distance_mm = config->avoid_distance_mm;
+	approach_distance_mm = config->approach_distance_mm;
+
+	int type;
+	for (type = 0; type < BEHAVIOR_TYPE_COUNT; type++)
+		behavior_registry[type].params = config->actions[type];
+
+	int channel;
+	bool rescaled = oversampling != config->oversampling; // the filters hold readings at the resolution oversampling gives
+	for (channel = 0; channel < ANALOG_CHANNEL_COUNT; channel++)
+	{ // only a filter whose setting (or scale) changed starts over; the others keep their readings
+		filter_setting* current = &sensor_filters[channel].setting;
+		if (rescaled || current->kind != config->filters[channel].kind || current->parameter != config->filters[channel].parameter)
+			set_filter(&sensor_filters[channel], config->filters[channel]);
+	}
+
+	adaptive_sampling = config->adaptive_sampling;
+	oversampling = config->oversampling;
+	if (rescaled)
+		make_channels_due(); // analog_hires still holds readings at the old resolution, and the thresholds are scaled to the new one
+	session_logging = config->session_log; // takes effect the next time the robot starts operating
+
+	if (config->telemetry_changed)
+	{ // the watcher closes the old link, in case closing it takes a while
+		telemetry_link* old_link = atomic_exchange(&retired_link, swap_telemetry(config->telemetry_link));
+		close_telemetry(old_link); // only if the watcher hasn't got to the one before yet, which hardly happens
+	}
+
+	*replaced_hierarchy = config->has_hierarchy;
+	if (config->has_hierarchy)
+		memcpy(subsumption_hierarchy, config->hierarchy, sizeof(subsumption_hierarchy));
+	if (same_order(subsumption_hierarchy, config->hierarchy))
+		memcpy(decision_table, config->table, sizeof(decision_table)); // new speeds or a new order change what the table holds
+	else
+		compile_decision_table(); // the gui changed the order and the file doesn't set one, so the watcher's table is for the wrong order
+	free(config);
+	return true;
+}
+
+/* WATCH THE CONFIGURATION FILE AND PUBLISH IT EVERY TIME IT CHANGES */
+static void* watch_config(void* path)
+{
+	struct stat last;
+	memset(&last, 0, sizeof(last));
+	stat((const char*)path, &last); // the file as it was when load_config read it
+
+	robot_config config;
+	while (true)
+	{
+		usleep(CONFIG_POLL_MICROSECONDS);
+		close_telemetry(atomic_exchange(&retired_link, NULL));
+
+		struct stat now;
+		if (stat((const char*)path, &now) != 0)
+			continue; // missing for now (editors often delete and rewrite), keep the current settings
+		if (now.st_mtim.tv_sec == last.st_mtim.tv_sec && now.st_mtim.tv_nsec == last.st_mtim.tv_nsec && now.st_size == last.st_size)
+			continue;
+		last = now;
+
+		if (parse_config((const char*)path, &config))
+		{
+			prepare_config(&config);
+			publish_config(&config);
+		}
+	}
+	return NULL;
+}
+
+/* READ THE CONFIGURATION ONCE AT STARTUP AND START WATCHING IT */
+bool load_config(const char* path)
+{
+	default_config.avoid_threshold = avoid_threshold;
+	default_config.approach_threshold = approach_threshold;
+	default_config.photo_threshold = photo_threshold;
+	default_config.avoid_distance_mm = avoid_distance_mm;
+	default_config.approach_distance_mm = approach_distance_mm;
+	int type;
+	for (type = 0; type < BEHAVIOR_TYPE_COUNT; type++)
+		default_config.actions[type] = behavior_registry[type].params;
+	memcpy(default_config.hierarchy, subsumption_hierarchy, sizeof(subsumption_hierarchy));
+	int channel;
+	for (channel = 0; channel < ANALOG_CHANNEL_COUNT; channel++)
+		default_config.filters[channel] = sensor_filters[channel].setting;
+	default_config.adaptive_sampling = adaptive_sampling;
+	default_config.oversampling = oversampling;
+	strcpy(default_config.telemetry, "off");
+	default_config.session_log = session_logging;
+	default_config.has_hierarchy = false;
+
+	robot_config config;
+	bool loaded_hierarchy = false;
+	if (parse_config(path, &config))
+	{
+		prepare_config(&config);
+		publish_config(&config);
+		apply_pending_config(&loaded_hierarchy);
+	}
+
+	pthread_t watcher;
+	if (pthread_create(&watcher, NULL, watch_config, (void*)path) == 0)
+		pthread_detach(watcher);
+	return loaded_hierarchy;
+}
@@ -0,0 +1,74 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (configuration file)
+
+Thresholds, action speeds and the hierarchy can be changed without recompiling by editing a configuration file.
+It is read once at startup and then watched by a background thread.  When the file changes, the watcher parses it
+into a complete new configuration, builds its decision table, opens its telemetry socket if the target changed, and
+hands it to the main loop, which copies it in between two decisions.  Everything that is slow (file access,
+parsing, sorting, building the table, sockets) therefore happens off the main loop.
+
+The format is one setting per line, anything after # is ignored, and settings that are left out keep their
+compiled-in value:
+
+	avoid_threshold 1600
+	approach_threshold 1600
+	photo_threshold 150
+	avoid_distance_cm 20
+	hierarchy ESCAPE_FRONT ESCAPE_BACK AVOID SEEK_LIGHT CRUISE_STRAIGHT
+	action AVOID 0.5 -0.5 0.1
+	filter LEFT_IR median 5
+	sampling adaptive
+	oversampling 4
+	telemetry udp:192.168.125.2:5005
+	session_log on
+
+"hierarchy" lists the active behaviors from the top down (titles with spaces written as underscores), every
+behavior that is not listed is inactive.  "action" sets the left speed, right speed and duration of one behavior.
+"avoid_distance_cm" and "approach_distance_cm" give the IR thresholds as distances instead (0 goes back to the
+readings); they only take effect on a robot with an IR calibration (see RE_Calibration.h).
+"filter" sets the filter of one analog channel (RIGHT_PHOTO, LEFT_PHOTO, RIGHT_IR, LEFT_IR or ALL) to none, or to
+mean, ema or median followed by its parameter (see RE_Filter.h).  "sampling adaptive" turns on the adaptive
+sampling planner (see RE_Sampling.h), "sampling every_pass" turns it off.  "oversampling" sets how many analog
+conversions are averaged into each reading: 1, 4, 16 or 64.  "telemetry" streams live frames to a receiver (see
+RE_Telemetry.h), or stops with "off".  "session_log on" logs every stretch of operating to a file (see RE_Log.h).
+*/
+
+#ifndef RE_CONFIG_H
+#define RE_CONFIG_H
+
+#include "RE_Engine.h"
+#include "RE_Filter.h"
+#include "RE_Telemetry.h"
+#include "RE_Log.h"
+
+#define CONFIG_PATH "robot_ethology.cfg"
+#define CONFIG_POLL_MICROSECONDS 250000 // how often the watcher checks the file for changes
+
+typedef struct robot_config
+{
+	int avoid_threshold;
+	int approach_threshold;
+	int photo_threshold;
+	int avoid_distance_mm;
+	int approach_distance_mm;
+	action_params actions[BEHAVIOR_TYPE_COUNT];
+	behavior hierarchy[BEHAVIOR_TYPE_COUNT]; // already sorted, ready to be copied over subsumption_hierarchy
+	bool has_hierarchy;						 // false if the file does not set a hierarchy
+	filter_setting filters[ANALOG_CHANNEL_COUNT];
+	bool adaptive_sampling;
+	int oversampling;
+	char telemetry[TELEMETRY_TARGET_LENGTH]; // "off" unless the file sets a target
+	bool session_log;
+
+	// filled in by the watcher before the configuration reaches the main loop
+	decision table[1 << CONDITION_BITS]; // the decision table for hierarchy and actions
+	bool telemetry_changed;				 // true if the target differs from the one the main loop is sending to
+	telemetry_link* telemetry_link;		 // the link to the new target (NULL for "off"), when telemetry_changed
+} robot_config;
+
+bool load_config(const char* path);							   // read the configuration file once (if there is one) and start watching it, returns true if it set the hierarchy
+bool apply_pending_config(bool* replaced_hierarchy);		   // copy a newly parsed configuration into the engine, returns false if there is none; [replaced_hierarchy] says whether it set the hierarchy
+bool parse_config(const char* path, robot_config* config);	   // parse a configuration file on top of the compiled-in values
+int find_behavior_type(const char* name);					   // look up a behavior by its title, with underscores for spaces
+
+#endif
@@ -0,0 +1,122 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (display)
+
+See RE_Display.h for how it is used.
+
+The frames are triple buffered: the main loop draws into one frame, the display thread shows another, and the
+third holds the newest submitted frame.  Handing a frame over in either direction is a single atomic exchange of
+the index of that third frame, so neither side ever waits for the other.
+
+Course:			211 - Perception & Action
+Instructors:	Ken Livingston, Joshua de Leeuw
+*/
+
+#include "RE_Display.h"
+#include "RE_Trace.h"
+#include <stdarg.h>	   // library for passing printf arguments along
+#include <string.h>	   // library for copying text into a frame
+#include <stdatomic.h> // library for swapping frames without locking
+#include <pthread.h>   // library for the display thread
+#include <unistd.h>	   // library for sleeping in the display thread
+
+#define NEW_FRAME_BIT 4 // set in ready_frame when it holds a frame that has not been shown yet
+
+static display_frame frames[3];
+static int drawing_frame = 0;			  // the frame the main loop draws into (only used by the main loop)
+static int showing_frame = 1;			  // the frame on the screen (only used by the display thread)
+static atomic_int ready_frame = 2;		  // the newest submitted frame, plus NEW_FRAME_BIT until it is shown
+static atomic_ulong frames_submitted = 0; // counters for get_display_stats
+static atomic_ulong frames_shown = 0;
+static atomic_ulong frames_skipped = 0;
+
+/* PUT ONE FRAME ON THE SCREEN */
+static void show_frame(const display_frame* frame)
+{
+	TRACE_BEGIN("show_frame");
+	TRACE_BEGIN("console_clear");
+	console_clear();
+	TRACE_END("console_clear");
+	int row;
+	for (row = 0; row < DISPLAY_ROWS; row++)
+	{
+		int length = DISPLAY_COLUMNS;
+		while (length > 0 && frame->lines[row][length - 1] == ' ')
+			length--; // leave out trailing spaces, and rows that are empty
+		if (length > 0)
+			display_printf(0, row, "%.*s", length, frame->lines[row]);
+	}
+	TRACE_END("show_frame");
+}
+
+/* SHOW EACH NEW FRAME AS IT ARRIVES */
+static void* run_display(void* unused)
+{
+	(void)unused;
+	TRACE_THREAD("display");
+	while (true)
+	{
+		if ((atomic_load(&ready_frame) & NEW_FRAME_BIT) == 0)
+		{
+			usleep(DISPLAY_POLL_MICROSECONDS); // nothing new to show
+			continue;
+		}
+		showing_frame = atomic_exchange(&ready_frame, showing_frame) & ~NEW_FRAME_BIT;
+		show_frame(&frames[showing_frame]);
+		atomic_fetch_add(&frames_shown, 1);
+	}
+	return NULL;
+}
+
+void start_display()
+{
+	pthread_t display_thread;
+	if (pthread_create(&display_thread, NULL, run_display, NULL) == 0)
+		pthread_detach(display_thread);
+}
+
+display_frame* begin_frame()
+{
+	display_frame* frame = &frames[drawing_frame];
+	int row;
+	for (row = 0; row < DISPLAY_ROWS; row++)
+	{
+		memset(frame->lines[row], ' ', DISPLAY_COLUMNS);
+		frame->lines[row][DISPLAY_COLUMNS] = '\0';
+	}
+	return frame;
+}
+
+void frame_printf(display_frame* frame, int column, int row, const char* format, ...)
+{
+	if (row < 0 || row >= DISPLAY_ROWS || column < 0 || column >= DISPLAY_COLUMNS)
+		return; // off the screen
+
+	char text[DISPLAY_COLUMNS + 1];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(text, sizeof(text), format, args);
+	va_end(args);
+
+	size_t length = strlen(text);
+	if (length > (size_t)(DISPLAY_COLUMNS - column))
+		length = DISPLAY_COLUMNS - column; // cut off what runs past the edge of the screen
+	memcpy(&frame->lines[row][column], text, length);
+}
+
+void submit_frame()
+{
+	int previous = atomic_exchange(&ready_frame, drawing_frame | NEW_FRAME_BIT);
+	if (previous & NEW_FRAME_BIT)
+		atomic_fetch_add(&frames_skipped, 1); // the display thread never got to that one
+	drawing_frame = previous & ~NEW_FRAME_BIT;
+	atomic_fetch_add(&frames_submitted, 1);
+}
+
+display_stats get_display_stats()
+{
+	display_stats stats;
+	stats.submitted = atomic_load(&frames_submitted);
+	stats.shown = atomic_load(&frames_shown);
+	stats.skipped = atomic_load(&frames_skipped);
+	return stats;
+}
@@ -0,0 +1,45 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (display)
+
+Writing to the Wombat's screen is slow, and a program that prints from its main loop makes the robot react late.
+Instead, the main loop draws each screen into a display_frame and submits it, which only copies a few indexes.
+A display thread shows the most recent submitted frame; if the main loop submits faster than the screen can keep
+up, the older frames are skipped rather than waited for.
+
+	display_frame* frame = begin_frame();
+	frame_printf(frame, 0, 0, "Hello %d", 42);
+	submit_frame();
+*/
+
+#ifndef RE_DISPLAY_H
+#define RE_DISPLAY_H
+
+#include "RE_Engine.h"
+
+#define DISPLAY_ROWS 10
+#define DISPLAY_COLUMNS 40
+#define DISPLAY_POLL_MICROSECONDS 20000 // how often the display thread looks for a new frame
+
+typedef struct display_frame
+{
+	char lines[DISPLAY_ROWS][DISPLAY_COLUMNS + 1]; // one string per row, padded with spaces
+} display_frame;
+
+typedef struct display_stats
+{
+	unsigned long submitted; // frames handed over by the main loop
+	unsigned long shown;	 // frames the display thread put on the screen
+	unsigned long skipped;	 // frames replaced by a newer one before they were shown
+} display_stats;
+
+void start_display();																   // start the display thread
+display_frame* begin_frame();														   // get a blank frame to draw the next screen into
+void frame_printf(display_frame* frame, int column, int row, const char* format, ...); // draw text at a position, like display_printf
+void submit_frame();																   // hand the frame from begin_frame to the display thread
+display_stats get_display_stats();													   // how many frames were submitted, shown and skipped so far
+
+// BUILT-IN FUNCTIONS
+void console_clear();											   // clear the console
+void display_printf(int column, int row, const char* format, ...); // print at a position on the screen
+
+#endif
@@ -0,0 +1,555 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine
+
+See RE_Engine.h for what lives here and how to build it.
+
+Course:			211 - Perception & Action
+Instructors:	Ken Livingston, Joshua de Leeuw
+*/
+
+#include "RE_Engine.h"
+#include "RE_Behaviors.h"
+#include "RE_Filter.h"
+#include "RE_Sampling.h"
+#include "RE_Calibration.h"
+#include "RE_Trace.h"
+
+// *** Variable Definitions *** //
+
+const pin_map* pins; // the wiring of this robot, set by start_engine
+
+// global variables to store all current sensor values accessible to all functions and updated by the "read_sensors" function
+int right_photo_value, left_photo_value, right_ir_value, left_ir_value;
+int front_bump_values[MAX_BUMPERS], back_bump_values[MAX_BUMPERS];
+
+// analog acquisition
+int oversampling = 1;					// analog conversions per reading; 1 reads each sensor once
+int analog_hires[ANALOG_CHANNEL_COUNT]; // the filtered readings of each channel, with oversampling_bits() extra bits
+int right_ir_mm, left_ir_mm;			// the IR readings as distances, once the IR sensors are calibrated
+unsigned long photo_pair_time, ir_pair_time; // when each pair was last read: the middle of its burst (ms)
+
+// threshold values
+int avoid_threshold = 1600;	   // the absolute difference between IR readings has to be above this for the avoid action
+int approach_threshold = 1600; // the absolute difference between IR readings has to be below this for the approach action
+int photo_threshold = 150;	   // the absolute difference between photo sensor readings has to be above this for seek light/dark actions
+int avoid_distance_mm = 0;	   // when above zero and the IR sensors are calibrated, avoid things closer than this instead of using avoid_threshold
+int approach_distance_mm = 0;  // when above zero and the IR sensors are calibrated, approach things closer than this instead of using approach_threshold
+
+// timer
+int timer_duration = 500;	  // the time in milliseconds to wait between calling action commands, changed by each drive command called by actions
+unsigned long start_time = 0; // store the system time each time we start an action so we can see if our time has elapsed without a blocking delay
+
+// motors
+bool servos_enabled = false;			  // true between start_motors() and stop_motors()
+long startup_ms = -1;					  // how long the last start_motors() took to get to the first drive after it
+static unsigned long startup_time = 0;	  // when start_motors() was last called
+static bool awaiting_first_drive = false; // true from start_motors() until the next drive
+
+/*
+The behavior registry, indexed by the behavior types and filled in from RE_BEHAVIORS.  The speeds can be changed
+from the configuration file.
+*/
+#define RE_REGISTRY_ENTRY(name, title, fires, mirrored, left, right, seconds) [name##_TYPE] = {title, {left, right, seconds}},
+behavior_definition behavior_registry[BEHAVIOR_TYPE_COUNT] = {RE_BEHAVIORS(RE_REGISTRY_ENTRY)};
+
+action_params stop_params = {0.0, 0.0, 0.25}; // used by stop() when no behavior wants to act
+
+/*
+This defines the initial hierarchy, but also lists all possible behaviors.
+The order can be moved around: the element at the top is at the top of the hierarchy.
+There is no need to change the rank value manually, just change the order and set
+the ones you want to be active to "true".  In the GUI program this runs until the gui is accessed.
+*/
+behavior subsumption_hierarchy[BEHAVIOR_TYPE_COUNT] = {
+	{ESCAPE_F_TYPE, 0, true},
+	{ESCAPE_B_TYPE, 1, true},
+	{AVOID_TYPE, 2, true},
+	{SEEK_LIGHT_TYPE, 3, true},
+	{CRUISE_S_TYPE, 4, true},
+	{SEEK_DARK_TYPE, BEHAVIOR_TYPE_COUNT + 1, false},
+	{APPROACH_TYPE, BEHAVIOR_TYPE_COUNT + 1, false},
+	{CRUISE_A_TYPE, BEHAVIOR_TYPE_COUNT + 1, false}};
+
+int hierarchy_length = BEHAVIOR_TYPE_COUNT;
+
+decision decision_table[1 << CONDITION_BITS]; // what to do for every combination of condition bits, filled in by compile_decision_table
+int current_behavior = NO_BEHAVIOR_TYPE;	   // the behavior we are currently driving for
+int current_conditions = 0;					   // the condition bits that behavior was chosen for
+
+const char* analog_channel_names[ANALOG_CHANNEL_COUNT] = {"RIGHT_PHOTO", "LEFT_PHOTO", "RIGHT_IR", "LEFT_IR"};
+
+// *** Function Definitions *** //
+
+//===================================//
+//===============SETUP===============//
+//===================================//
+
+void start_engine(const pin_map* robot_pins)
+{
+	pins = robot_pins;
+	start_motors();							  // the servos settle while we load and compile below
+	load_ir_calibration(IR_CALIBRATION_PATH); // if this robot has been calibrated, its IR readings can be used as distances
+	compile_decision_table(); // build the decision table for the starting hierarchy
+}
+
+//========================================//
+//===============PERCEPTION===============//
+//========================================//
+
+int oversampling_bits()
+{
+	int bits = 0;
+	while ((1 << (2 * (bits + 1))) <= oversampling)
+		bits++; // every 4x oversampling adds one bit
+	return bits;
+}
+
+/*
+Read a right/left pair of analog sensors as one burst: [oversampling] conversions of each, alternating right and
+left so both sides are sampled over the same moment.  The sums are decimated (keeping the extra bits of
+resolution), passed through the filters into analog_hires, and rounded back to the normal scale for [right_value]
+and [left_value].  Both sides get the one [pair_time], the middle of the burst.  The pair is read if the sampling
+planner says either side is due.
+*/
+static void read_pair(int right_channel, int right_pin, int* right_value, int left_channel, int left_pin, int* left_value,
+					  unsigned long* pair_time, unsigned long now)
+{
+	if (!channel_due(right_channel, now) && !channel_due(left_channel, now))
+		return; // keep the last readings
+
+	long right_sum = 0;
+	long left_sum = 0;
+	unsigned long burst_start = systime();
+	int i;
+	for (i = 0; i < oversampling; i++)
+	{
+		right_sum += analog_et(right_pin);
+		left_sum += analog_et(left_pin);
+	}
+	*pair_time = burst_start + (systime() - burst_start) / 2;
+
+	int extra_bits = oversampling_bits(); // each 4x oversampling only halves the noise, so it buys one bit
+	int half = (1 << extra_bits) >> 1;
+	analog_hires[right_channel] = filter_sample(&sensor_filters[right_channel], (int)(right_sum >> extra_bits));
+	analog_hires[left_channel] = filter_sample(&sensor_filters[left_channel], (int)(left_sum >> extra_bits));
+	*right_value = (analog_hires[right_channel] + half) >> extra_bits;
+	*left_value = (analog_hires[left_channel] + half) >> extra_bits;
+	channel_sampled(right_channel, *right_value, now);
+	channel_sampled(left_channel, *left_value, now);
+}
+
+void read_sensors()
+{
+	TRACE_BEGIN("read_sensors");
+	unsigned long now = systime(); // for the sampling planner
+
+	// read each pair of analog sensors that is due and pass them through their filters (which do nothing unless one is set)
+	read_pair(RIGHT_PHOTO_CHANNEL, pins->right_photo, &right_photo_value, LEFT_PHOTO_CHANNEL, pins->left_photo, &left_photo_value,
+			  &photo_pair_time, now); // *** NOTE: greater value means less light ***
+	read_pair(RIGHT_IR_CHANNEL, pins->right_ir, &right_ir_value, LEFT_IR_CHANNEL, pins->left_ir, &left_ir_value, &ir_pair_time, now);
+	if (ir_calibrated)
+	{
+		right_ir_mm = ir_to_mm(RIGHT_IR_CHANNEL, right_ir_value); // a table lookup each
+		left_ir_mm = ir_to_mm(LEFT_IR_CHANNEL, left_ir_value);
+	}
+
+	int i;
+	for (i = 0; i < pins->front_bump_count; i++)
+		front_bump_values[i] = digital(pins->front_bumps[i]); // read the front bumpers
+	for (i = 0; i < pins->back_bump_count; i++)
+		back_bump_values[i] = digital(pins->back_bumps[i]); // read the back bumpers
+	bumpers_sampled(now);								  // bumpers are read on every pass
+	TRACE_END("read_sensors");
+}
+
+bool is_above_photo_differential(int threshold)
+{
+	TRACE_BEGIN("is_above_photo_differential");
+	int photo_difference = abs(analog_hires[RIGHT_PHOTO_CHANNEL] - analog_hires[LEFT_PHOTO_CHANNEL]); // get the difference between the photo values, at the finer resolution
+	TRACE_END("is_above_photo_differential");
+	return photo_difference > (threshold * (1 << oversampling_bits())); // returns true if the absolute difference between photo sensors is greater than the threshold, otherwise false
+}
+
+bool is_above_distance_threshold(int threshold)
+{
+	TRACE_BEGIN("is_above_distance_threshold");
+	int scaled = threshold * (1 << oversampling_bits()); // compare at the finer resolution of the oversampled readings
+	bool left_above = analog_hires[LEFT_IR_CHANNEL] > scaled, right_above = analog_hires[RIGHT_IR_CHANNEL] > scaled;
+	bool above = left_above != right_above;
+	TRACE_END("is_above_distance_threshold");
+	return above; // returns true if one (exclusive) IR value is above the threshold, otherwise false
+}
+
+bool is_closer_than(int distance_mm)
+{
+	TRACE_BEGIN("is_closer_than");
+	bool closer = (left_ir_mm < distance_mm) != (right_ir_mm < distance_mm);
+	TRACE_END("is_closer_than");
+	return closer; // returns true if one (exclusive) IR sensor sees something closer than the distance, otherwise false
+}
+
+/* TRUE IF ONE IR SENSOR IS PAST A THRESHOLD: THE DISTANCE WHEN ONE IS SET AND THE SENSORS ARE CALIBRATED, OTHERWISE THE READING */
+static bool ir_past(int hires, int mm, int threshold, int distance_mm, int extra_bits)
+{
+	TRACE_BEGIN("ir_past");
+	bool past;
+	if (distance_mm > 0 && ir_calibrated)
+		past = mm < distance_mm;
+	else
+		past = hires > (threshold * (1 << extra_bits)); // at the finer resolution of the oversampled readings
+	TRACE_END("ir_past");
+	return past;
+}
+
+bool is_front_bump()
+{
+	TRACE_BEGIN("is_front_bump");
+	bool bumped = false;
+	int i;
+	for (i = 0; i < pins->front_bump_count && !bumped; i++)
+		bumped = front_bump_values[i] == 1; // true if one of the front bump values is 1, otherwise false
+	TRACE_END("is_front_bump");
+	return bumped;
+}
+
+bool is_back_bump()
+{
+	TRACE_BEGIN("is_back_bump");
+	bool bumped = false;
+	int i;
+	for (i = 0; i < pins->back_bump_count && !bumped; i++)
+		bumped = back_bump_values[i] == 1; // true if one of the back bump values is 1, otherwise false
+	TRACE_END("is_back_bump");
+	return bumped;
+}
+
+int sense_conditions()
+{
+	TRACE_BEGIN("sense_conditions");
+	int extra_bits = oversampling_bits();
+	int photo_difference = analog_hires[RIGHT_PHOTO_CHANNEL] - analog_hires[LEFT_PHOTO_CHANNEL]; // at the finer resolution, so small differences aren't rounded away
+	int conditions = 0;
+	if (is_front_bump())
+		conditions |= FRONT_BUMP_BIT;
+	if (is_back_bump())
+		conditions |= BACK_BUMP_BIT;
+	if (ir_past(analog_hires[LEFT_IR_CHANNEL], left_ir_mm, avoid_threshold, avoid_distance_mm, extra_bits))
+		conditions |= LEFT_AVOID_BIT;
+	if (ir_past(analog_hires[RIGHT_IR_CHANNEL], right_ir_mm, avoid_threshold, avoid_distance_mm, extra_bits))
+		conditions |= RIGHT_AVOID_BIT;
+	if (ir_past(analog_hires[LEFT_IR_CHANNEL], left_ir_mm, approach_threshold, approach_distance_mm, extra_bits))
+		conditions |= LEFT_APPROACH_BIT;
+	if (ir_past(analog_hires[RIGHT_IR_CHANNEL], right_ir_mm, approach_threshold, approach_distance_mm, extra_bits))
+		conditions |= RIGHT_APPROACH_BIT;
+	TRACE_BEGIN("photo_conditions");
+	if (abs(photo_difference) > (photo_threshold * (1 << extra_bits)))
+		conditions |= PHOTO_BIT;
+	if (photo_difference > 0)
+		conditions |= RIGHT_DARKER_BIT;
+	TRACE_END("photo_conditions");
+	TRACE_END("sense_conditions");
+	return conditions;
+}
+
+//====================================//
+//===============ACTION===============//
+//====================================//
+
+/*
+The drive function takes the left and right motor speeds and a delay time amount as inputs and triggers the wheels to drive.
+
+Inputs:
+	[left] The left wheel speed, between -1.0 and 1.0
+	[right] The right wheel speed, between -1.0 and 1.0
+	[delay_seconds] The delay time in seconds (0 to MAX_FLOAT)
+*/
+void drive(float left, float right, float delay_seconds)
+{
+	TRACE_BEGIN("drive");
+	float left_speed = map(left, -1.0, 1.0, pins->servo_low, pins->servo_high); // call the map function to map our speed (set between -1 and 1) to the appropriate range of motor values
+	float right_speed = map(right, -1.0, 1.0, pins->servo_high, pins->servo_low);
+
+	timer_duration = (int)(delay_seconds * 1000.0); // multiply our desired time in seconds by 1000 to get milliseconds and update this global variable
+	start_time = systime();							// update our start time to reflect the time we start driving (in ms)
+
+	set_servo_position(pins->left_motor, left_speed);
+	set_servo_position(pins->right_motor, right_speed); // set the servos to run at the mapped speed
+
+	if (awaiting_first_drive)
+	{ // the first decision since the motors were started
+		startup_ms = (long)(start_time - startup_time);
+		awaiting_first_drive = false;
+	}
+	TRACE_END("drive");
+}
+
+/*
+Start the motors at power-on and when the robot starts operating again.  The servos need SERVO_SETTLE_MS after being
+enabled, so the timer is set to just that.  The main loop keeps reading the sensors meanwhile, and ready_to_decide()
+also waits for their filters, so both get ready at the same time.  The time until the first drive after this is kept
+in startup_ms.  Servos that are already enabled are left alone, along with whatever they are doing.
+*/
+void start_motors()
+{
+	if (servos_enabled)
+		return;
+	enable_servo(pins->left_motor);
+	enable_servo(pins->right_motor);
+	servos_enabled = true;
+	drive(0.0, 0.0, SERVO_SETTLE_MS / 1000.0); // set speed to zero
+	startup_time = start_time;
+	startup_ms = -1;
+	awaiting_first_drive = true;
+}
+
+void stop_motors()
+{
+	if (servos_enabled)
+	{
+		disable_servos();
+		servos_enabled = false;
+	}
+}
+
+void drive_action(action_params params, bool mirrored)
+{
+	if (mirrored)
+		drive(params.right, params.left, params.seconds);
+	else
+		drive(params.left, params.right, params.seconds);
+}
+
+/* PLAN ONE BEHAVIOR WITH THE SPEEDS IN [actions], OR THE REGISTRY SPEEDS IF IT IS NULL */
+static bool plan_behavior_from(const action_params* actions, int type, int conditions, decision* out)
+{
+	if (type < 0 || type >= BEHAVIOR_TYPE_COUNT)
+		return false;
+	action_params params = (actions != NULL) ? actions[type] : behavior_registry[type].params;
+
+	switch (type)
+	{ // one case per behavior in RE_BEHAVIORS: if it fires, fill in how it drives
+#define RE_PLAN_CASE(name, title, fires, mirrored, left, right, seconds)    \
+	case name##_TYPE:                                                       \
+		if (!name##_fires(conditions))                                      \
+			return false;                                                   \
+		fill_decision_from(params, type, name##_mirrored(conditions), out); \
+		return true;
+		RE_BEHAVIORS(RE_PLAN_CASE)
+	}
+	return false;
+}
+
+bool plan_behavior(int type, int conditions, decision* out)
+{
+	return plan_behavior_from(NULL, type, conditions, out);
+}
+
+void run_behavior(int type)
+{
+	decision planned;
+	current_conditions = sense_conditions();
+	if (plan_behavior(type, current_conditions, &planned))
+		drive_decision(&planned);
+}
+
+void drive_decision(const decision* winner)
+{
+	current_behavior = winner->type;
+	drive_action(winner->params, false);
+}
+
+void cruise_straight()
+{
+	run_behavior(CRUISE_S_TYPE);
+}
+
+void cruise_arc()
+{
+	run_behavior(CRUISE_A_TYPE);
+}
+
+void stop()
+{
+	current_behavior = NO_BEHAVIOR_TYPE;
+	drive_action(stop_params, false);
+}
+
+void escape_front()
+{
+	run_behavior(ESCAPE_F_TYPE); //drive backwards in an arc
+}
+
+void escape_back()
+{
+	run_behavior(ESCAPE_B_TYPE); //drive forward a little
+}
+
+void seek_light()
+{
+	run_behavior(SEEK_LIGHT_TYPE);
+}
+
+void seek_dark()
+{
+	run_behavior(SEEK_DARK_TYPE);
+}
+
+void avoid()
+{
+	run_behavior(AVOID_TYPE);
+}
+
+void approach()
+{
+	run_behavior(APPROACH_TYPE);
+}
+
+//=========================================//
+//===============ARBITRATION===============//
+//=========================================//
+
+/*
+This comparator function is used in the qsort function for sorting our behavior list.
+Active things always go before inactive things, and if both are active then the are ordered by rank.
+*/
+static int compare_ranks(const void* a, const void* b)
+{
+	bool is_active_a = ((const behavior*)a)->is_active;
+	bool is_active_b = ((const behavior*)b)->is_active;
+	if (is_active_a != is_active_b)
+	{
+		return is_active_b;
+	}
+	int rank_a = ((const behavior*)a)->rank;
+	int rank_b = ((const behavior*)b)->rank;
+	return (rank_a - rank_b);
+}
+
+void sort_hierarchy(behavior* array, size_t len)
+{
+	TRACE_BEGIN("sort_hierarchy");
+	qsort(array, len, sizeof(behavior), compare_ranks); // sort our hierarchy based on rank value
+
+	size_t i;
+	for (i = 0; i < len; i++)
+	{
+		if (array[i].is_active)
+			array[i].rank = i; // now reset the index of each sorted active behavior to be sequential with a step size of one
+		else
+			array[i].rank = len + 1; // give inactive behaviors a constant "poor" rank which is helpful to ensure new ones always jump above.
+	}
+	TRACE_END("sort_hierarchy");
+}
+
+void compile_decision_table()
+{
+	TRACE_BEGIN("compile_decision_table");
+	build_decision_table(subsumption_hierarchy, hierarchy_length, NULL, decision_table);
+	TRACE_END("compile_decision_table");
+}
+
+/* WALK A HIERARCHY FOR ONE SET OF CONDITIONS, WITH THE SPEEDS IN [actions] OR THE REGISTRY SPEEDS IF IT IS NULL */
+static void plan_hierarchy_from(const behavior* hierarchy, int length, const action_params* actions, int conditions, decision* out)
+{
+	int i;
+	for (i = 0; i < length; i++)
+	{ // the first active behavior that fires wins
+		if (hierarchy[i].is_active && plan_behavior_from(actions, hierarchy[i].type, conditions, out))
+			return;
+	}
+	out->type = NO_BEHAVIOR_TYPE; // if nothing fires, we stop
+	out->params = stop_params;
+}
+
+void plan_hierarchy(int conditions, decision* out)
+{
+	plan_hierarchy_from(subsumption_hierarchy, hierarchy_length, NULL, conditions, out);
+}
+
+void build_decision_table(const behavior* hierarchy, int length, const action_params* actions, decision* table)
+{
+	int conditions;
+	for (conditions = 0; conditions < (1 << CONDITION_BITS); conditions++)
+		plan_hierarchy_from(hierarchy, length, actions, conditions, &table[conditions]);
+}
+
+void arbitrate()
+{
+	TRACE_BEGIN("arbitrate");
+	current_conditions = sense_conditions();
+	drive_decision(&decision_table[current_conditions]);
+	TRACE_END("arbitrate");
+}
+
+void dump_decision_table(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+		return;
+
+	char filters[160];
+	describe_filters(filters, sizeof(filters));
+	fprintf(file, "# avoid_threshold %d approach_threshold %d photo_threshold %d\n", avoid_threshold, approach_threshold, photo_threshold);
+	fprintf(file, "# avoid_distance_mm %d approach_distance_mm %d (%s)\n", avoid_distance_mm, approach_distance_mm,
+			ir_calibrated ? "IR calibrated" : "IR not calibrated, distances are not used");
+	fprintf(file, "# filters %s oversampling %d\n", filters, oversampling); // the settings this run uses, so they are on record next to the table
+	fprintf(file, "# F=front bump B=back bump Av=IR above avoid_threshold (left/right) Ap=IR above approach_threshold (left/right)\n");
+	fprintf(file, "# P=photo difference above photo_threshold D=right photo darker\n");
+	fprintf(file, "# F B AvL AvR ApL ApR P D  behavior            left  right seconds\n");
+
+	int conditions;
+	for (conditions = 0; conditions < (1 << CONDITION_BITS); conditions++)
+	{
+		const decision* entry = &decision_table[conditions];
+		const char* title = (entry->type == NO_BEHAVIOR_TYPE) ? "STOP" : behavior_registry[entry->type].title;
+
+		int bit;
+		fprintf(file, " ");
+		for (bit = 0; bit < CONDITION_BITS; bit++)
+			fprintf(file, " %d%s", (conditions >> bit) & 1, (bit >= 2 && bit <= 5) ? "  " : "");
+		fprintf(file, "  %-18s %5.2f %5.2f %5.2f\n", title, entry->params.left, entry->params.right, entry->params.seconds);
+	}
+	fclose(file);
+}
+
+//=====================================//
+//===============HELPERS===============//
+//=====================================//
+
+bool timer_elapsed()
+{
+	return (systime() > (start_time + timer_duration)); // return true if the current time is greater than our start time plus timer duration
+}
+
+bool sensors_warmed_up()
+{
+	int channel;
+	for (channel = 0; channel < ANALOG_CHANNEL_COUNT; channel++)
+	{
+		if (!filter_warmed_up(&sensor_filters[channel]))
+			return false;
+	}
+	return true;
+}
+
+bool ready_to_decide()
+{
+	return timer_elapsed() && sensors_warmed_up(); // a half-filled filter would decide on too few readings
+}
+
+/*
+Map a value from an input range to a new value in a new range.
+
+Inputs:
+	[value] the starting number to remap
+	[start_range_low] the low value of the initial bounds
+	[start_range_high] the high value of the initial bounds
+	[target_range_low] the low value of the target bounds
+	[target_range_high] the high value of the target bounds
+
+Returns the remapped value as a float
+*/
+float map(float value, float start_range_low, float start_range_high, float target_range_low, float target_range_high)
+{
+	return target_range_low + ((value - start_range_low) / (start_range_high - start_range_low)) * (target_range_high - target_range_low);
+}
@@ -0,0 +1,217 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine
+
+Shared code for the Plain, GUI and Template programs: reading the sensors, the perception checks, driving, the
+action functions, the behavior registry and the subsumption hierarchy with its decision table.  Each program
+describes how its robot is wired with a pin_map and calls start_engine() before its main loop.
+
+To build a program on the Wombat, add the .h files of the Engine folder to the project's include folder and the
+.c files to its src folder next to the program itself.
+
+Course:			211 - Perception & Action
+Instructors:	Ken Livingston, Joshua de Leeuw
+*/
+
+#ifndef RE_ENGINE_H
+#define RE_ENGINE_H
+
+// *** Import Libraries *** //
+
+#include <stdlib.h>	 // library for general purpose functions
+#include <stdbool.h> // library for boolean support
+#include <stdio.h>	 // library for writing the decision table
+
+// *** Pin Map *** //
+
+#define MAX_BUMPERS 3 // the most bumpers a robot can have on the front (and on the back)
+
+/*
+Every robot is wired a little differently, so each program describes its own wiring (and servo range) here
+instead of with #defines.  Bumper lists only use their first front_bump_count / back_bump_count entries.
+*/
+typedef struct pin_map
+{
+	int right_ir, left_ir, right_photo, left_photo; // analog sensors (IRs, photos)
+	int front_bumps[MAX_BUMPERS];					// digital sensors (bumpers) on the front
+	int front_bump_count;
+	int back_bumps[MAX_BUMPERS]; // digital sensors (bumpers) on the back
+	int back_bump_count;
+	int right_motor, left_motor; // servos
+	float servo_low, servo_high; // servo positions for full speed backward and full speed forward on the left wheel (the right wheel is mirrored)
+} pin_map;
+
+// Define the analog channels, these index the per-channel settings (filters, sampling)
+#define RIGHT_PHOTO_CHANNEL 0
+#define LEFT_PHOTO_CHANNEL 1
+#define RIGHT_IR_CHANNEL 2
+#define LEFT_IR_CHANNEL 3
+#define ANALOG_CHANNEL_COUNT 4
+
+#define SERVO_SETTLE_MS 100 // how long the servos need after enable_servo() before they hold still
+
+// *** Behaviors *** //
+
+// Define behavior types, these index the behavior registry
+#define SEEK_LIGHT_TYPE 0
+#define SEEK_DARK_TYPE 1
+#define APPROACH_TYPE 2
+#define AVOID_TYPE 3
+#define ESCAPE_F_TYPE 4
+#define ESCAPE_B_TYPE 5
+#define CRUISE_S_TYPE 6
+#define CRUISE_A_TYPE 7
+#define BEHAVIOR_TYPE_COUNT 8
+
+#define NO_BEHAVIOR_TYPE -1 // no active behavior applies, so we stop
+
+/*
+Each action drives with a left speed, right speed and duration.  Actions that react to one side (seek light/dark,
+avoid, approach) store the speeds for one case and swap left and right for the other; the registry says which.
+*/
+typedef struct action_params
+{
+	float left;	   // left motor speed, between -1.0 and 1.0
+	float right;   // right motor speed, between -1.0 and 1.0
+	float seconds; // how long to drive before the next decision
+} action_params;
+
+/*
+The behavior registry has one entry per behavior type: the title shown in the gui and used in the configuration
+file, and the speeds its action drives with.  When a behavior fires is decided by plan_behavior().
+*/
+typedef struct behavior_definition
+{
+	const char* title;
+	action_params params;
+} behavior_definition;
+
+/*
+An entry of the subsumption hierarchy: which behavior it is, where it ranks and whether it is active.
+*/
+typedef struct behavior
+{
+	int type;
+	int rank;
+	bool is_active;
+} behavior;
+
+// *** Decision Table *** //
+
+/*
+With a fixed hierarchy and fixed thresholds, the behavior that wins only depends on a few yes/no sensor conditions.
+sense_conditions() packs those into a small number, and compile_decision_table() works out ahead of time what to do
+for every possible number.  Each decision is then a single table lookup, and the table only has to be rebuilt when
+the hierarchy or the action speeds change.
+*/
+#define FRONT_BUMP_BIT (1 << 0)		// a front bumper is pressed
+#define BACK_BUMP_BIT (1 << 1)		// a back bumper is pressed
+#define LEFT_AVOID_BIT (1 << 2)		// left IR is above avoid_threshold (or closer than avoid_distance_mm)
+#define RIGHT_AVOID_BIT (1 << 3)	// right IR is above avoid_threshold (or closer than avoid_distance_mm)
+#define LEFT_APPROACH_BIT (1 << 4)	// left IR is above approach_threshold (or closer than approach_distance_mm)
+#define RIGHT_APPROACH_BIT (1 << 5) // right IR is above approach_threshold (or closer than approach_distance_mm)
+#define PHOTO_BIT (1 << 6)			// the photo sensors differ by more than photo_threshold
+#define RIGHT_DARKER_BIT (1 << 7)	// the right photo value is greater (darker) than the left one
+#define CONDITION_BITS 8
+
+typedef struct decision
+{
+	int type;			  // the behavior that wins, or NO_BEHAVIOR_TYPE
+	action_params params; // the speeds and duration to drive with, already mirrored for the side that triggered
+} decision;
+
+// *** Function Declarations *** //
+
+// SETUP
+void start_engine(const pin_map* pins); // remember the wiring, start the motors and get ready to decide
+
+// PERCEPTION FUNCTIONS
+void read_sensors();							 // read all sensor values and save to global variables
+bool is_above_distance_threshold(int threshold); // return true if one and only one IR sensor is above the specified threshold
+bool is_above_photo_differential(int threshold); // return true if the absolute difference between photo sensor values is above the specified threshold
+bool is_closer_than(int distance_mm);			 // return true if one and only one IR sensor sees something closer than the distance (needs a calibration)
+bool is_front_bump();							 // return true if one of the front bumpers was hit
+bool is_back_bump();							 // return true if one of the back bumpers was hit
+int sense_conditions();							 // pack the current sensor values into condition bits for the decision table
+int oversampling_bits();						 // the extra bits of resolution the current oversampling gives analog_hires
+
+// ACTION FUNCTIONS
+void escape_front();
+void escape_back();
+void seek_light();
+void seek_dark();
+void avoid();
+void approach();
+void cruise_straight();
+void cruise_arc();
+void stop();
+void run_behavior(int type);											// run one behavior on its own, if its condition holds for the current sensor values
+bool plan_behavior(int type, int conditions, decision* out);			// work out whether a behavior fires for the given conditions and how it would drive
+void drive_action(action_params params, bool mirrored);					// drive with action speeds, swapping left and right if mirrored
+void drive_decision(const decision* winner);							// drive with a decision and remember it as the current behavior
+
+// ARBITRATION
+void sort_hierarchy(behavior* array, size_t len); // sort a hierarchy by rank and renumber the ranks
+void plan_hierarchy(int conditions, decision* out); // walk subsumption_hierarchy for one set of conditions (what the decision table caches)
+void compile_decision_table();					  // rebuild the decision table from subsumption_hierarchy and the registry
+void build_decision_table(const behavior* hierarchy, int length, const action_params* actions, decision* table); // fill in a table for any hierarchy and speeds (NULL for the registry's)
+void arbitrate();								  // drive with whatever the hierarchy decides for the current sensor values
+void dump_decision_table(const char* path);		  // write the decision table to a text file
+
+// MOTOR CONTROL
+void drive(float left, float right, float delay_seconds); // drive with the specified left and right motor speeds for a number of seconds
+void start_motors();									  // enable the servos and stand still while they settle; does nothing if they are already enabled
+void stop_motors();										  // disable the servos unless they already are
+
+// HELPER FUNCTIONS
+bool timer_elapsed();	  // return true if our timer has elapsed
+bool sensors_warmed_up(); // return true once every analog filter has seen enough readings to fill its window
+bool ready_to_decide();	  // return true if our timer has elapsed and the sensors are warmed up
+float map(float value, float start_range_low, float start_range_high, float target_range_low, float target_range_high);
+// remap a value from a source range to a new range
+
+// BUILT-IN FUNCTIONS
+void enable_servo(int pin);						// enable servo at the specified pin
+void disable_servos();							// disable all servos
+int analog_et(int pin);							// get the 10-bit analog value of a sensor on the specified pin
+int digital(int pin);							// get the digital value of a sensor on the specified pin
+unsigned long systime();						// get the system time
+void set_servo_position(int pin, int position); // set a servo at the specified pin to the specified position
+
+// *** Variable Declarations *** //
+
+// global variables to store all current sensor values accessible to all functions and updated by the "read_sensors" function
+extern int right_photo_value, left_photo_value, right_ir_value, left_ir_value;
+extern int front_bump_values[MAX_BUMPERS], back_bump_values[MAX_BUMPERS]; // in the order of the pin map
+
+// analog acquisition: the right and left sensor of each pair are read together, [oversampling] times each
+extern int oversampling;						   // analog conversions per reading, 1 (the default), 4, 16 or 64
+extern int analog_hires[ANALOG_CHANNEL_COUNT]; // the filtered readings with oversampling_bits() extra bits of resolution, indexed by channel; the threshold checks use these
+extern int right_ir_mm, left_ir_mm;			   // the IR readings as distances in mm, once the IR sensors are calibrated (see RE_Calibration.h)
+extern unsigned long photo_pair_time, ir_pair_time; // the system time at which each pair was last read, the middle of its burst (the log and telemetry carry these)
+
+// threshold values
+extern int avoid_threshold;	   // the absolute difference between IR readings has to be above this for the avoid action
+extern int approach_threshold; // the absolute difference between IR readings has to be below this for the approach action
+extern int photo_threshold;	   // the absolute difference between photo sensor readings has to be above this for seek light/dark actions
+extern int avoid_distance_mm;	   // when above zero and the IR sensors are calibrated, used instead of avoid_threshold
+extern int approach_distance_mm;   // when above zero and the IR sensors are calibrated, used instead of approach_threshold
+
+// timer
+extern int timer_duration;		  // the time in milliseconds to wait between calling action commands, changed by each drive command called by actions
+extern unsigned long start_time; // store the system time each time we start an action so we can see if our time has elapsed without a blocking delay
+
+// motors
+extern bool servos_enabled;		 // true between start_motors() and stop_motors(), so neither repeats what is already done
+extern long startup_ms;			 // how long the last start_motors() took to get to the first drive after it (ms), -1 until then
+
+// behaviors
+extern behavior_definition behavior_registry[BEHAVIOR_TYPE_COUNT]; // indexed by behavior type
+extern action_params stop_params;								   // used by stop() when no behavior wants to act
+extern behavior subsumption_hierarchy[BEHAVIOR_TYPE_COUNT];		   // one entry per behavior, the top of the hierarchy first
+extern int hierarchy_length;
+extern decision decision_table[1 << CONDITION_BITS];
+extern int current_behavior;   // the type of the last decision driven, or NO_BEHAVIOR_TYPE
+extern int current_conditions; // the condition bits arbitrate() or run_behavior() last sensed
+extern const char* analog_channel_names[ANALOG_CHANNEL_COUNT]; // "RIGHT_PHOTO", "LEFT_PHOTO", "RIGHT_IR", "LEFT_IR"
+
+#endif
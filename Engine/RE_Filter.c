@@ -0,0 +1,130 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (sensor filters)
+
+See RE_Filter.h for the kinds of filter.
+
+Course:			211 - Perception & Action
+Instructors:	Ken Livingston, Joshua de Leeuw
+*/
+
+#include "RE_Filter.h"
+#include <string.h> // library for clearing a filter
+
+sensor_filter sensor_filters[ANALOG_CHANNEL_COUNT]; // all FILTER_NONE to begin with
+
+const char* filter_kind_names[FILTER_KIND_COUNT] = {"none", "mean", "ema", "median"};
+
+bool set_filter(sensor_filter* filter, filter_setting setting)
+{
+	switch (setting.kind)
+	{
+	case FILTER_NONE:
+		setting.parameter = 0;
+		break;
+	case FILTER_MEAN:
+	case FILTER_MEDIAN:
+		if (setting.parameter < 1 || setting.parameter > MAX_FILTER_WINDOW)
+			return false;
+		break;
+	case FILTER_EMA:
+		if (setting.parameter < 1 || setting.parameter > MAX_EMA_SHIFT)
+			return false;
+		break;
+	default:
+		return false;
+	}
+
+	memset(filter, 0, sizeof(sensor_filter));
+	filter->setting = setting;
+	return true;
+}
+
+/* THE MEDIAN OF THE READINGS IN THE WINDOW */
+static int window_median(const sensor_filter* filter)
+{
+	int sorted[MAX_FILTER_WINDOW];
+	int i, j;
+	for (i = 0; i < filter->count; i++)
+	{ // insertion sort, the window is never more than a handful of readings
+		int value = filter->samples[i];
+		for (j = i; j > 0 && sorted[j - 1] > value; j--)
+			sorted[j] = sorted[j - 1];
+		sorted[j] = value;
+	}
+	return sorted[filter->count / 2];
+}
+
+int filter_sample(sensor_filter* filter, int raw)
+{
+	int window = filter->setting.parameter;
+	switch (filter->setting.kind)
+	{
+	case FILTER_MEAN:
+		if (filter->count == window)
+			filter->sum -= filter->samples[filter->next]; // the oldest reading leaves the window
+		else
+			filter->count++;
+		filter->samples[filter->next] = raw;
+		filter->sum += raw;
+		filter->next = (filter->next + 1) % window;
+		return (int)((filter->sum + filter->count / 2) / filter->count); // rounded to the nearest whole number
+
+	case FILTER_MEDIAN:
+		if (filter->count < window)
+			filter->count++;
+		filter->samples[filter->next] = raw;
+		filter->next = (filter->next + 1) % window;
+		return window_median(filter);
+
+	case FILTER_EMA:
+		if (filter->count == 0)
+		{
+			filter->ema = (long)raw << EMA_FRACTION_BITS; // start from the first reading instead of from zero
+			filter->count = 1;
+		}
+		else
+		{
+			filter->ema += (((long)raw << EMA_FRACTION_BITS) - filter->ema) / (1L << filter->setting.parameter); // the step is negative while the readings fall, so divide instead of shifting
+			if (filter->count < (1 << filter->setting.parameter))
+				filter->count++;
+		}
+		return (int)((filter->ema + (1 << (EMA_FRACTION_BITS - 1))) >> EMA_FRACTION_BITS);
+
+	default:
+		return raw;
+	}
+}
+
+bool filter_warmed_up(const sensor_filter* filter)
+{
+	switch (filter->setting.kind)
+	{
+	case FILTER_MEAN:
+	case FILTER_MEDIAN:
+		return filter->count >= filter->setting.parameter;
+	case FILTER_EMA:
+		return filter->count >= (1 << filter->setting.parameter); // about one time constant of readings
+	default:
+		return true;
+	}
+}
+
+void describe_filters(char* text, size_t size)
+{
+	size_t used = 0;
+	int channel;
+	text[0] = '\0';
+	for (channel = 0; channel < ANALOG_CHANNEL_COUNT && used < size; channel++)
+	{
+		const filter_setting* setting = &sensor_filters[channel].setting;
+		int written;
+		if (setting->kind == FILTER_NONE)
+			written = snprintf(text + used, size - used, "%s%s=none", channel ? " " : "", analog_channel_names[channel]);
+		else
+			written = snprintf(text + used, size - used, "%s%s=%s/%d", channel ? " " : "", analog_channel_names[channel],
+							   filter_kind_names[setting->kind], setting->parameter);
+		if (written < 0)
+			break;
+		used += written;
+	}
+}
@@ -0,0 +1,55 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (sensor filters)
+
+A single noisy reading can push an IR or photo value over its threshold and start an action for nothing.  Each
+analog channel can therefore be passed through a filter between reading it and the perception checks:
+
+	FILTER_NONE		the raw reading (the default)
+	FILTER_MEAN		the average of the last [parameter] readings
+	FILTER_EMA		an exponential moving average where each new reading counts for 1 / 2^[parameter]
+	FILTER_MEDIAN	the median of the last [parameter] readings, which ignores single spikes completely
+
+All of them use whole numbers only.  The mean and EMA cost the same few operations per reading whatever their
+size; the median sorts its (small) window every reading.
+*/
+
+#ifndef RE_FILTER_H
+#define RE_FILTER_H
+
+#include "RE_Engine.h"
+
+#define FILTER_NONE 0
+#define FILTER_MEAN 1
+#define FILTER_EMA 2
+#define FILTER_MEDIAN 3
+#define FILTER_KIND_COUNT 4
+
+#define MAX_FILTER_WINDOW 9	  // the most readings a mean or median filter can look back over
+#define MAX_EMA_SHIFT 8		  // the slowest EMA: each reading counts for 1/256
+#define EMA_FRACTION_BITS 8	  // the EMA keeps this many bits below the decimal point
+
+typedef struct filter_setting
+{
+	int kind;	   // one of the FILTER_ values
+	int parameter; // the window for FILTER_MEAN and FILTER_MEDIAN, the shift for FILTER_EMA
+} filter_setting;
+
+typedef struct sensor_filter
+{
+	filter_setting setting;
+	int samples[MAX_FILTER_WINDOW]; // the last readings, oldest overwritten first
+	int next;						// where the next reading goes in samples
+	int count;						// how many readings samples holds, up to the window
+	long sum;						// the sum of samples, for FILTER_MEAN
+	long ema;						// the running average scaled by 2^EMA_FRACTION_BITS, for FILTER_EMA
+} sensor_filter;
+
+extern sensor_filter sensor_filters[ANALOG_CHANNEL_COUNT]; // one per analog channel, used by read_sensors
+extern const char* filter_kind_names[FILTER_KIND_COUNT];	   // "none", "mean", "ema", "median"
+
+bool set_filter(sensor_filter* filter, filter_setting setting);		  // change a filter and forget its readings, returns false if the setting is out of range
+int filter_sample(sensor_filter* filter, int raw);					  // add one reading and return the filtered value
+bool filter_warmed_up(const sensor_filter* filter);					  // true once the filter has seen enough readings to fill its window
+void describe_filters(char* text, size_t size);						  // write the filter setting of every channel as one line of text
+
+#endif
@@ -0,0 +1,311 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (session logs, writing)
+
+See RE_Log.h for the format.
+
+Records are put together in a buffer of our own and written out a block at a time, so most frames cost a few
+comparisons and a few bytes copied.  The buffer is also written out and flushed after every keyframe, so a robot that
+is switched off without closing the log loses at most the frames since the last one.  The file offsets of the
+keyframes are collected as we go and written as the index when the log is closed.
+
+Course:			211 - Perception & Action
+Instructors:	Ken Livingston, Joshua de Leeuw
+*/
+
+#include "RE_Log.h"
+#include <time.h>  // library for the wall clock time in the file name and header
+#include <errno.h> // library for telling a name that is taken from other reasons a log can't be created
+
+#define LOG_BUFFER_SIZE 16384 // bytes collected before they are written to the file
+#define LOG_RECORD_MAX 96	  // the longest record (a keyframe), so a record always fits once the buffer is flushed
+#define LOG_NAME_ATTEMPTS 100 // names start_session_log tries before giving up
+
+bool session_logging = false;
+
+static FILE* log_file = NULL;
+static unsigned char buffer[LOG_BUFFER_SIZE];
+static size_t buffered = 0;
+static unsigned long written = 0; // bytes in the file so far, including the buffer: the offset of the next record
+
+static unsigned long frames_logged = 0;
+static unsigned long session_start;	  // systime() of the first frame
+static unsigned long last_frame_time; // systime() of the last frame
+static log_state last;				  // the last frame logged
+static unsigned long run_frames = 0;  // frames repeating the last one that are not written yet
+static unsigned long run_ms = 0;
+static long photo_age, ir_age;		  // the pair ages last written, which frames without LOG_AGES_CHANGED repeat
+
+static unsigned long* keyframe_offsets = NULL; // the offset of keyframe i, which is frame i * LOG_INDEX_INTERVAL
+static unsigned long* keyframe_times = NULL;
+static size_t keyframe_capacity = 0;
+
+/* WRITE THE BUFFER TO THE FILE */
+static void flush_buffer()
+{
+	fwrite(buffer, 1, buffered, log_file);
+	buffered = 0;
+}
+
+static void put_byte(unsigned char byte)
+{
+	buffer[buffered++] = byte;
+	written++;
+}
+
+/* APPEND A NUMBER, 7 BITS PER BYTE WITH THE TOP BIT SET ON ALL BUT THE LAST */
+static void put_number(unsigned long value)
+{
+	while (value >= 0x80)
+	{
+		put_byte((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	put_byte((unsigned char)value);
+}
+
+/* APPEND A NUMBER THAT CAN BE NEGATIVE: 0, -1, 1, -2 ... BECOME 0, 1, 2, 3 ... */
+static void put_signed(long value)
+{
+	put_number(value < 0 ? ((unsigned long)(-(value + 1)) << 1) | 1 : (unsigned long)value << 1);
+}
+
+/* MAKE ROOM FOR THE NEXT RECORD */
+static void reserve_record()
+{
+	if (buffered + LOG_RECORD_MAX > LOG_BUFFER_SIZE)
+		flush_buffer();
+}
+
+/* WRITE OUT THE FRAMES THAT REPEATED THE LAST ONE */
+static void flush_run()
+{
+	if (run_frames == 0)
+		return;
+	reserve_record();
+	put_byte(LOG_RUN_TAG);
+	put_number(run_frames);
+	put_number(run_ms);
+	run_frames = 0;
+	run_ms = 0;
+}
+
+/* WRITE THE COMPLETE STATE, AND REMEMBER WHERE IT IS FOR THE INDEX */
+static void write_keyframe(const log_state* state)
+{
+	size_t keyframe = state->frame / LOG_INDEX_INTERVAL;
+	if (keyframe == keyframe_capacity)
+	{ // this only happens every few hundred keyframes
+		size_t capacity = (keyframe_capacity == 0) ? 256 : keyframe_capacity * 2;
+		unsigned long* offsets = realloc(keyframe_offsets, capacity * sizeof(unsigned long));
+		unsigned long* times = realloc(keyframe_times, capacity * sizeof(unsigned long));
+		if (offsets != NULL)
+			keyframe_offsets = offsets;
+		if (times != NULL)
+			keyframe_times = times;
+		if (offsets != NULL && times != NULL)
+			keyframe_capacity = capacity; // otherwise the index stops here: the log reads the same, only seeking past here is slower
+	}
+
+	reserve_record();
+	if (keyframe < keyframe_capacity)
+	{
+		keyframe_offsets[keyframe] = written;
+		keyframe_times[keyframe] = state->time;
+	}
+	put_byte(LOG_KEYFRAME_TAG);
+	put_number(state->frame);
+	put_number(state->time);
+	int channel;
+	for (channel = 0; channel < ANALOG_CHANNEL_COUNT; channel++)
+		put_signed(state->analog[channel]);
+	photo_age = (long)state->time - state->photo_time; // ages rather than times, so they stay small
+	ir_age = (long)state->time - state->ir_time;
+	put_signed(photo_age);
+	put_signed(ir_age);
+	put_number((unsigned long)state->front_bumps);
+	put_number((unsigned long)state->back_bumps);
+	put_signed(state->behavior);
+	put_number((unsigned long)state->action_ms);
+}
+
+/* WRITE ONE FRAME AS THE DIFFERENCES FROM THE LAST ONE */
+static void write_changes(const log_state* state, unsigned long elapsed_ms, int changed)
+{
+	long new_photo_age = (long)state->time - state->photo_time;
+	long new_ir_age = (long)state->time - state->ir_time;
+	if (((changed & LOG_PHOTO_CHANGED) && new_photo_age != photo_age) || ((changed & LOG_IR_CHANGED) && new_ir_age != ir_age))
+		changed |= LOG_AGES_CHANGED; // most of the time both pairs are read in the pass that logs them, and the ages stay 0
+
+	reserve_record();
+	put_byte((unsigned char)changed);
+	put_number(elapsed_ms);
+	int channel;
+	for (channel = 0; channel < ANALOG_CHANNEL_COUNT; channel++)
+	{
+		if (changed & LOG_ANALOG_CHANGED(channel))
+			put_signed(state->analog[channel] - last.analog[channel]);
+	}
+	if ((changed & LOG_AGES_CHANGED) && (changed & LOG_PHOTO_CHANGED))
+		put_signed(photo_age = new_photo_age);
+	if ((changed & LOG_AGES_CHANGED) && (changed & LOG_IR_CHANGED))
+		put_signed(ir_age = new_ir_age);
+	if (changed & LOG_BUMPS_CHANGED)
+	{
+		put_number((unsigned long)state->front_bumps);
+		put_number((unsigned long)state->back_bumps);
+	}
+	if (changed & LOG_BEHAVIOR_CHANGED)
+	{
+		put_signed(state->behavior);
+		put_number((unsigned long)state->action_ms);
+	}
+}
+
+void session_log_name(char* name, size_t size, int sequence)
+{
+	time_t now = time(NULL);
+	size_t length = strftime(name, size, "session_%Y%m%d_%H%M%S", localtime(&now));
+	if (sequence > 0)
+		snprintf(name + length, size - length, "_%d.relog", sequence);
+	else
+		snprintf(name + length, size - length, ".relog");
+}
+
+bool open_session_log(const char* path)
+{
+	close_session_log(); // in case one is still open
+	log_file = fopen(path, "wbx"); // never over an existing log, e.g. one started in the same second
+	if (log_file == NULL)
+		return false;
+
+	buffered = 0;
+	written = 0;
+	frames_logged = 0;
+	run_frames = 0;
+	run_ms = 0;
+
+	const char* magic = "RELOG";
+	while (*magic != '\0')
+		put_byte((unsigned char)*magic++);
+	put_byte(LOG_VERSION);
+	put_number(LOG_INDEX_INTERVAL);
+	put_number((unsigned long)time(NULL));
+	return true;
+}
+
+bool start_session_log()
+{
+	char name[64];
+	int sequence;
+	for (sequence = 0; sequence < LOG_NAME_ATTEMPTS; sequence++)
+	{
+		session_log_name(name, sizeof(name), sequence);
+		if (open_session_log(name))
+			return true;
+		if (errno != EEXIST)
+			return false; // another name won't help
+	}
+	return false;
+}
+
+void log_frame()
+{
+	if (log_file == NULL)
+		return;
+	unsigned long now = systime();
+	if (frames_logged == 0)
+		session_start = now;
+	else if (now - last_frame_time < LOG_PERIOD_MS)
+		return;
+
+	log_state state;
+	state.frame = frames_logged++;
+	state.time = now - session_start;
+	state.analog[RIGHT_PHOTO_CHANNEL] = right_photo_value;
+	state.analog[LEFT_PHOTO_CHANNEL] = left_photo_value;
+	state.analog[RIGHT_IR_CHANNEL] = right_ir_value;
+	state.analog[LEFT_IR_CHANNEL] = left_ir_value;
+	state.photo_time = (long)photo_pair_time - (long)session_start; // can be negative, for a pair read before the first frame
+	state.ir_time = (long)ir_pair_time - (long)session_start;
+	state.front_bumps = 0;
+	state.back_bumps = 0;
+	int i;
+	for (i = 0; i < MAX_BUMPERS; i++)
+	{
+		state.front_bumps |= (front_bump_values[i] == 1) << i;
+		state.back_bumps |= (back_bump_values[i] == 1) << i;
+	}
+	state.behavior = current_behavior;
+	state.action_ms = timer_duration;
+
+	if (state.frame % LOG_INDEX_INTERVAL == 0)
+	{
+		flush_run(); // a run never reaches past a keyframe, so reading can start at one
+		write_keyframe(&state);
+		flush_buffer();
+		fflush(log_file); // at most LOG_INDEX_INTERVAL frames are lost if the log is never closed
+	}
+	else
+	{
+		int changed = 0;
+		int channel;
+		for (channel = 0; channel < ANALOG_CHANNEL_COUNT; channel++)
+		{
+			if (state.analog[channel] != last.analog[channel])
+				changed |= LOG_ANALOG_CHANGED(channel);
+		}
+		if (state.front_bumps != last.front_bumps || state.back_bumps != last.back_bumps)
+			changed |= LOG_BUMPS_CHANGED;
+		if (state.behavior != last.behavior || state.action_ms != last.action_ms)
+			changed |= LOG_BEHAVIOR_CHANGED;
+
+		if (changed == 0)
+		{ // the common case
+			run_frames++;
+			run_ms += now - last_frame_time;
+		}
+		else
+		{
+			flush_run();
+			write_changes(&state, now - last_frame_time, changed);
+		}
+	}
+	last = state;
+	last_frame_time = now;
+}
+
+void close_session_log()
+{
+	if (log_file == NULL)
+		return;
+	flush_run();
+
+	size_t keyframes = (frames_logged + LOG_INDEX_INTERVAL - 1) / LOG_INDEX_INTERVAL;
+	if (keyframes > keyframe_capacity)
+		keyframes = keyframe_capacity; // keyframes we had no memory to remember
+	unsigned long index_offset = written;
+	reserve_record();
+	put_byte(LOG_INDEX_TAG);
+	put_number(keyframes);
+	size_t i;
+	for (i = 0; i < keyframes; i++)
+	{
+		reserve_record();
+		put_number(i * LOG_INDEX_INTERVAL);
+		put_number(keyframe_times[i]);
+		put_number(keyframe_offsets[i]);
+	}
+	reserve_record();
+	uint32_t footer[2] = {(uint32_t)index_offset, LOG_FOOTER_MAGIC}; // little-endian, like the robot
+	for (i = 0; i < sizeof(footer); i++)
+		put_byte(((unsigned char*)footer)[i]);
+
+	flush_buffer();
+	fclose(log_file);
+	log_file = NULL;
+	free(keyframe_offsets);
+	free(keyframe_times);
+	keyframe_offsets = NULL;
+	keyframe_times = NULL;
+	keyframe_capacity = 0;
+}
@@ -0,0 +1,93 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (session logs)
+
+Records what the robot sensed and did for a whole session, compactly enough that hours of running fit in a few
+megabytes.  Turn it on with "session_log on" in the configuration file (see RE_Config.h); the GUI program then writes
+one session_YYYYMMDD_HHMMSS.relog file for each stretch of operating (session_YYYYMMDD_HHMMSS_1.relog and so on if
+that name is taken), and Tools/re_log.c prints them.
+
+A frame is logged every LOG_PERIOD_MS.  Most frames repeat the one before: the bumpers are almost always released and
+the behavior rarely changes.  So the file stores what changed, not what is:
+
+	header		"RELOG", the format version, the keyframe interval and the wall clock time the session started
+	frame		a tag byte saying which values changed, the milliseconds since the last frame, then only the changes:
+				an analog channel as the difference from its last value, then, if the tag says the ages changed,
+				how many milliseconds before the frame each pair with a changed channel was read (otherwise it was
+				read as long before as the last age written for it), the bumpers as their new masks (a mask holds
+				until the next one, so each is one run), the behavior and action length as an event
+	run			a number of frames in a row in which nothing changed, and the milliseconds they took
+	keyframe	the complete state, every LOG_INDEX_INTERVAL frames, so reading can start there
+	index		the frame number, time and file offset of every keyframe, then a footer with the index's offset
+				(written when the log is closed: without it, the reader finds the keyframes by reading from the start)
+
+Numbers are written as variable-length integers (7 bits per byte, small numbers take one byte), and differences are
+zigzag encoded first so small negative ones stay small.  Reading needs no engine: Tools link RE_LogReader.c only.
+*/
+
+#ifndef RE_LOG_H
+#define RE_LOG_H
+
+#include "RE_Engine.h"
+#include <stdint.h> // library for the fixed-width footer
+
+#define LOG_PERIOD_MS 10		  // at most one frame every this many milliseconds
+#define LOG_INDEX_INTERVAL 1024 // a keyframe every this many frames
+#define LOG_VERSION 2 // version 1 logs have no pair times, and still read
+
+// Record tags: a frame's tag is the LOG_*_CHANGED bits of what changed, the other records have their own tag
+#define LOG_ANALOG_CHANGED(channel) (1 << (channel)) // one bit per analog channel
+#define LOG_PHOTO_CHANGED (LOG_ANALOG_CHANGED(RIGHT_PHOTO_CHANNEL) | LOG_ANALOG_CHANGED(LEFT_PHOTO_CHANNEL))
+#define LOG_IR_CHANGED (LOG_ANALOG_CHANGED(RIGHT_IR_CHANNEL) | LOG_ANALOG_CHANGED(LEFT_IR_CHANNEL))
+#define LOG_BUMPS_CHANGED (1 << 4)
+#define LOG_BEHAVIOR_CHANGED (1 << 5)
+#define LOG_AGES_CHANGED (1 << 7) // the other records' tags all have bit 6 set and bit 7 clear
+#define LOG_RUN_TAG 0x40
+#define LOG_KEYFRAME_TAG 0x41
+#define LOG_INDEX_TAG 0x42
+#define LOG_FOOTER_MAGIC 0x58454c52u // "RLEX" after the index offset, the last four bytes of a finished log
+
+/*
+The state of the robot at one frame, as the writer logs it and the reader rebuilds it.
+*/
+typedef struct log_state
+{
+	unsigned long frame;			  // frames since the session started
+	unsigned long time;				  // milliseconds since the session started
+	int analog[ANALOG_CHANNEL_COUNT]; // the filtered readings, indexed by channel
+	long photo_time, ir_time;		  // when the photo and IR readings were taken, the middle of their burst (ms since the session started); a later burst that reads the same values doesn't move them
+	int front_bumps, back_bumps;	  // one bit per bumper, in the order of the pin map
+	int behavior;					  // current_behavior
+	int action_ms;					  // how long the current action drives for
+} log_state;
+
+// WRITING (on the robot)
+extern bool session_logging; // whether the GUI program logs its sessions, false unless the configuration file turns it on
+bool open_session_log(const char* path); // start a new log, returns false if the file exists already or can't be created
+bool start_session_log();				 // open_session_log() under the first session_log_name() that isn't taken
+void log_frame();						 // log the current values, if LOG_PERIOD_MS has passed since the last frame
+void close_session_log();				 // write the index and close the log (a log that was never closed can still be read)
+void session_log_name(char* name, size_t size, int sequence); // a file name from the wall clock time, session_YYYYMMDD_HHMMSS.relog, or session_YYYYMMDD_HHMMSS_[sequence].relog after the first
+
+// READING (RE_LogReader.c, also on a desktop computer)
+typedef struct log_reader
+{
+	const unsigned char* data; // the whole file, e.g. memory-mapped
+	size_t size;
+	size_t records_start;	// the first record, after the header
+	size_t position;		// the next record
+	size_t records_end;		// where the index starts, or the end of the file
+	size_t index_position;	// where the index's entries start, or 0 if the log was never closed
+	unsigned long interval; // the keyframe interval
+	int version;			// LOG_VERSION, or an older one
+	int photo_age, ir_age;	// the pair ages last read, which frames repeat until they change
+	long long started;		// the wall clock time the session started (seconds since 1970)
+	log_state state;		// the last frame read
+	unsigned long run_frames, run_ms; // what is left of a run that is being read
+} log_reader;
+
+bool open_log_reader(log_reader* reader, const unsigned char* data, size_t size); // check the header and find the index, returns false if it is not a session log
+bool next_log_frame(log_reader* reader, log_state* frame, unsigned long* elapsed_ms); // read one frame and the milliseconds since the previous one, returns false at the end
+bool next_log_span(log_reader* reader, log_state* frame, unsigned long* frames, unsigned long* elapsed_ms); // like next_log_frame, but a run comes back whole
+bool seek_log_frame(log_reader* reader, unsigned long frame); // make the frame the next one read, starting from the keyframe before it; returns false if it is past the end
+
+#endif
@@ -0,0 +1,265 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (session logs, reading)
+
+See RE_Log.h for the format.
+
+The reader works on the whole file in memory (the tools memory-map it) and never allocates, so any number of logs
+can be read side by side.  It only uses the definitions in RE_Log.h and RE_Engine.h, not the engine itself, so desktop
+tools can link this file on its own.
+
+Course:			211 - Perception & Action
+Instructors:	Ken Livingston, Joshua de Leeuw
+*/
+
+#include "RE_Log.h"
+#include <string.h> // library for checking the header
+
+/* READ A NUMBER, RETURNS FALSE IF THE FILE ENDS IN THE MIDDLE OF IT */
+static bool get_number(log_reader* reader, size_t end, unsigned long* value)
+{
+	unsigned long result = 0;
+	int shift = 0;
+	while (reader->position < end && shift < 64)
+	{
+		unsigned char byte = reader->data[reader->position++];
+		result |= (unsigned long)(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			*value = result;
+			return true;
+		}
+		shift += 7;
+	}
+	return false;
+}
+
+/* READ A SMALL NUMBER (A BUMPER MASK, AN ACTION LENGTH) */
+static bool get_int(log_reader* reader, size_t end, int* value)
+{
+	unsigned long number;
+	if (!get_number(reader, end, &number))
+		return false;
+	*value = (int)number;
+	return true;
+}
+
+/* READ A NUMBER THAT CAN BE NEGATIVE */
+static bool get_signed(log_reader* reader, size_t end, int* value)
+{
+	unsigned long number;
+	if (!get_number(reader, end, &number))
+		return false;
+	*value = (number & 1) ? -(int)(number >> 1) - 1 : (int)(number >> 1);
+	return true;
+}
+
+bool open_log_reader(log_reader* reader, const unsigned char* data, size_t size)
+{
+	memset(reader, 0, sizeof(*reader));
+	reader->data = data;
+	reader->size = size;
+	reader->records_end = size;
+	if (size < 6 || memcmp(data, "RELOG", 5) != 0 || data[5] < 1 || data[5] > LOG_VERSION)
+		return false;
+	reader->version = data[5];
+
+	unsigned long started;
+	reader->position = 6;
+	if (!get_number(reader, size, &reader->interval) || !get_number(reader, size, &started) || reader->interval == 0)
+		return false;
+	reader->started = (long long)started;
+	reader->records_start = reader->position;
+
+	if (size >= reader->position + 8)
+	{ // a finished log ends with the offset of its index and the footer magic
+		uint32_t footer[2];
+		memcpy(footer, data + size - 8, 8);
+		if (footer[1] == LOG_FOOTER_MAGIC && footer[0] >= reader->position && footer[0] < size - 8 && data[footer[0]] == LOG_INDEX_TAG)
+		{
+			reader->records_end = footer[0];
+			reader->index_position = footer[0] + 1;
+		}
+	}
+	reader->state.behavior = NO_BEHAVIOR_TYPE;
+	return true;
+}
+
+bool next_log_span(log_reader* reader, log_state* frame, unsigned long* frames, unsigned long* elapsed_ms)
+{
+	log_state* state = &reader->state;
+	size_t end = reader->records_end;
+	if (reader->run_frames > 0)
+	{ // the rest of a run that next_log_frame started
+		*frames = reader->run_frames;
+		*elapsed_ms = reader->run_ms;
+		state->frame += reader->run_frames;
+		state->time += reader->run_ms;
+		reader->run_frames = 0;
+		reader->run_ms = 0;
+		*frame = *state;
+		return true;
+	}
+	if (reader->position >= end)
+		return false;
+
+	unsigned char tag = reader->data[reader->position++];
+	bool ok = true;
+	int channel;
+	if (tag == LOG_RUN_TAG)
+	{
+		ok = get_number(reader, end, frames) && get_number(reader, end, elapsed_ms) && *frames > 0;
+		state->frame += *frames;
+		state->time += *elapsed_ms;
+	}
+	else if (tag == LOG_KEYFRAME_TAG)
+	{
+		unsigned long time = 0;
+		ok = get_number(reader, end, &state->frame) && get_number(reader, end, &time);
+		for (channel = 0; ok && channel < ANALOG_CHANNEL_COUNT; channel++)
+			ok = get_signed(reader, end, &state->analog[channel]);
+		if (reader->version >= 2)
+			ok = ok && get_signed(reader, end, &reader->photo_age) && get_signed(reader, end, &reader->ir_age);
+		state->photo_time = (long)time - reader->photo_age; // the ages stay 0 in version 1 logs, which have none
+		state->ir_time = (long)time - reader->ir_age;
+		ok = ok && get_int(reader, end, &state->front_bumps) && get_int(reader, end, &state->back_bumps) &&
+			 get_signed(reader, end, &state->behavior) && get_int(reader, end, &state->action_ms);
+		*frames = 1;
+		*elapsed_ms = (time < state->time) ? 0 : time - state->time;
+		state->time = time;
+	}
+	else if ((tag & LOG_RUN_TAG) == 0)
+	{ // a frame: the tag holds the LOG_*_CHANGED bits
+		ok = get_number(reader, end, elapsed_ms);
+		for (channel = 0; ok && channel < ANALOG_CHANNEL_COUNT; channel++)
+		{
+			int difference;
+			if (tag & LOG_ANALOG_CHANGED(channel))
+			{
+				ok = get_signed(reader, end, &difference);
+				state->analog[channel] += difference;
+			}
+		}
+		if (ok && (tag & LOG_AGES_CHANGED) && (tag & LOG_PHOTO_CHANGED))
+			ok = get_signed(reader, end, &reader->photo_age);
+		if (ok && (tag & LOG_AGES_CHANGED) && (tag & LOG_IR_CHANGED))
+			ok = get_signed(reader, end, &reader->ir_age);
+		unsigned long time = state->time + *elapsed_ms;
+		if (tag & LOG_PHOTO_CHANGED)
+			state->photo_time = (long)time - reader->photo_age;
+		if (tag & LOG_IR_CHANGED)
+			state->ir_time = (long)time - reader->ir_age;
+		if (ok && (tag & LOG_BUMPS_CHANGED))
+			ok = get_int(reader, end, &state->front_bumps) && get_int(reader, end, &state->back_bumps);
+		if (ok && (tag & LOG_BEHAVIOR_CHANGED))
+			ok = get_signed(reader, end, &state->behavior) && get_int(reader, end, &state->action_ms);
+		state->frame++;
+		state->time += *elapsed_ms;
+		*frames = 1;
+	}
+	else
+	{
+		ok = false; // not a record we know
+	}
+
+	if (!ok)
+	{ // a log cut off in the middle of a record (the robot was switched off): stop at the last whole one
+		reader->position = end;
+		return false;
+	}
+	*frame = *state;
+	return true;
+}
+
+bool next_log_frame(log_reader* reader, log_state* frame, unsigned long* elapsed_ms)
+{
+	if (reader->run_frames == 0)
+	{
+		unsigned long frames;
+		size_t position = reader->position;
+		log_state before = reader->state;
+		if (!next_log_span(reader, frame, &frames, elapsed_ms))
+			return false;
+		if (frames == 1)
+			return true;
+
+		if (reader->data[position] == LOG_RUN_TAG)
+		{ // hand out a run one frame at a time
+			reader->state = before;
+			reader->run_frames = frames;
+			reader->run_ms = *elapsed_ms;
+		}
+	}
+
+	unsigned long share = reader->run_ms / reader->run_frames; // the frames of a run share its time evenly
+	*elapsed_ms = share;
+	reader->state.frame++;
+	reader->state.time += share;
+	reader->run_frames--;
+	reader->run_ms -= share;
+	*frame = reader->state;
+	return true;
+}
+
+bool seek_log_frame(log_reader* reader, unsigned long frame)
+{
+	size_t start = reader->records_start; // the last keyframe at or before the frame: the first one, unless the index knows a later one
+	unsigned long start_time = 0;
+	if (reader->index_position > 0)
+	{
+		unsigned long count, keyframe, time, offset;
+		size_t end = reader->size - 8;
+		reader->position = reader->index_position;
+		bool ok = get_number(reader, end, &count);
+		while (ok && count-- > 0 && (ok = get_number(reader, end, &keyframe) && get_number(reader, end, &time) && get_number(reader, end, &offset)) && keyframe <= frame)
+		{
+			start = offset;
+			start_time = time;
+		}
+	}
+	else
+	{ // a log that was never closed has no index: read up to the frame, remembering the last keyframe on the way
+		log_state ignored;
+		unsigned long frames, elapsed_ms;
+		reader->position = reader->records_start;
+		reader->run_frames = 0;
+		reader->run_ms = 0;
+		size_t position = reader->position;
+		while (next_log_span(reader, &ignored, &frames, &elapsed_ms))
+		{
+			if (reader->data[position] == LOG_KEYFRAME_TAG && reader->state.frame <= frame)
+			{
+				start = position;
+				start_time = reader->state.time;
+			}
+			if (reader->state.frame >= frame)
+				break;
+			position = reader->position;
+		}
+	}
+
+	reader->position = start;
+	reader->run_frames = 0;
+	reader->run_ms = 0;
+	reader->state.time = start_time; // so the keyframe reads as following straight on from where we were
+	if (reader->position >= reader->records_end || reader->data[reader->position] != LOG_KEYFRAME_TAG)
+		return false;
+
+	log_state ignored;
+	unsigned long elapsed_ms;
+	size_t keyframe_position = reader->position;
+	if (!next_log_frame(reader, &ignored, &elapsed_ms))
+		return false;
+	if (reader->state.frame >= frame)
+	{ // the frame is the keyframe itself: read it again next
+		reader->position = keyframe_position;
+		reader->state.time = start_time;
+		return reader->state.frame == frame;
+	}
+	while (reader->state.frame + 1 < frame)
+	{ // from the keyframe up to the frame before the one we want
+		if (!next_log_frame(reader, &ignored, &elapsed_ms))
+			return false;
+	}
+	log_reader ahead = *reader; // the frame itself has to be there too, without reading it
+	return next_log_frame(&ahead, &ignored, &elapsed_ms);
+}
@@ -0,0 +1,133 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (adaptive sampling)
+
+See RE_Sampling.h for the sampling rates.
+
+Course:			211 - Perception & Action
+Instructors:	Ken Livingston, Joshua de Leeuw
+*/
+
+#include "RE_Sampling.h"
+#include "RE_Calibration.h"
+#include "RE_Filter.h"
+
+typedef struct channel_schedule
+{
+	unsigned long next_due; // the system time at which the channel is read next
+	unsigned long samples;	// readings since the last reset
+} channel_schedule;
+
+bool adaptive_sampling = false;
+
+static channel_schedule schedules[ANALOG_CHANNEL_COUNT];
+static unsigned long bumper_samples = 0;
+static unsigned long passes = 0;	   // passes of the main loop, counted with the bumpers since they are read every pass
+static unsigned long report_start = 0; // when counting started
+static unsigned long report_end = 0;   // the last time anything was read
+
+bool channel_due(int channel, unsigned long now)
+{
+	if (!filter_warmed_up(&sensor_filters[channel]))
+		return true; // fill the filter as fast as we can, so the first decision doesn't wait for it
+	return !adaptive_sampling || now >= schedules[channel].next_due;
+}
+
+/* HOW FAR AN IR READING IS FROM ONE THRESHOLD, FROM 0 (URGENT) TO 1000 (CALM); IN MM IF THE THRESHOLD IS A DISTANCE */
+static int calmness(int channel, int value, int threshold, int distance_mm)
+{
+	int margin, urgent, calm;
+	if (distance_mm > 0 && ir_calibrated)
+	{
+		margin = abs(ir_to_mm(channel, value) - distance_mm);
+		urgent = IR_URGENT_MARGIN_MM;
+		calm = IR_CALM_MARGIN_MM;
+	}
+	else
+	{
+		margin = abs(value - threshold);
+		urgent = IR_URGENT_MARGIN;
+		calm = IR_CALM_MARGIN;
+	}
+
+	if (margin <= urgent)
+		return 0;
+	if (margin >= calm)
+		return 1000;
+	return 1000 * (margin - urgent) / (calm - urgent);
+}
+
+/* HOW LONG TO WAIT BEFORE READING AN IR SENSOR AGAIN, GIVEN ITS LAST READING */
+static unsigned long ir_period(int channel, int value)
+{
+	int avoid_calmness = calmness(channel, value, avoid_threshold, avoid_distance_mm);
+	int approach_calmness = calmness(channel, value, approach_threshold, approach_distance_mm);
+	int least = (avoid_calmness < approach_calmness) ? avoid_calmness : approach_calmness;
+	return (unsigned long)(IR_CALM_PERIOD_MS * least / 1000); // every pass when close to a threshold
+}
+
+/* HOW LONG TO WAIT BEFORE READING A PHOTO SENSOR AGAIN, GIVEN WHAT THE ROBOT IS DOING */
+static unsigned long photo_period()
+{
+	bool cruising = current_behavior == CRUISE_S_TYPE || current_behavior == CRUISE_A_TYPE || current_behavior == NO_BEHAVIOR_TYPE;
+	return cruising ? PHOTO_CRUISE_PERIOD_MS : PHOTO_ACTIVE_PERIOD_MS;
+}
+
+void channel_sampled(int channel, int value, unsigned long now)
+{
+	bool is_ir = channel == RIGHT_IR_CHANNEL || channel == LEFT_IR_CHANNEL;
+	schedules[channel].samples++;
+	schedules[channel].next_due = now + (is_ir ? ir_period(channel, value) : photo_period());
+	report_end = now;
+}
+
+void bumpers_sampled(unsigned long now)
+{
+	bumper_samples++;
+	passes++;
+	report_end = now;
+}
+
+void write_sampling_report(FILE* file)
+{
+	double seconds = (report_end - report_start) / 1000.0;
+	fprintf(file, "# sampling: %s, %lu passes over %.1f s\n", adaptive_sampling ? "adaptive" : "every pass", passes, seconds);
+	fprintf(file, "# channel       readings     per second  readings per pass\n");
+
+	unsigned long total = 0;
+	int channel;
+	for (channel = 0; channel < ANALOG_CHANNEL_COUNT; channel++)
+	{
+		unsigned long samples = schedules[channel].samples;
+		total += samples;
+		fprintf(file, "%-12s %11lu %14.1f %18.3f\n", analog_channel_names[channel], samples,
+				seconds > 0 ? samples / seconds : 0.0, passes > 0 ? (double)samples / passes : 0.0);
+	}
+	fprintf(file, "%-12s %11lu %14.1f %18.3f\n", "BUMPERS", bumper_samples,
+			seconds > 0 ? bumper_samples / seconds : 0.0, passes > 0 ? (double)bumper_samples / passes : 0.0);
+	fprintf(file, "# analog readings: %lu of %lu a full-rate loop would take, %d conversion(s) each\n", total, passes * ANALOG_CHANNEL_COUNT, oversampling);
+	if (startup_ms >= 0)
+		fprintf(file, "# first decision %ld ms after starting\n", startup_ms);
+	else
+		fprintf(file, "# no decision since starting\n");
+}
+
+void make_channels_due()
+{
+	int channel;
+	for (channel = 0; channel < ANALOG_CHANNEL_COUNT; channel++)
+		schedules[channel].next_due = 0;
+}
+
+void reset_sampling_report(unsigned long now)
+{
+	int channel;
+	for (channel = 0; channel < ANALOG_CHANNEL_COUNT; channel++)
+	{
+		schedules[channel].samples = 0;
+		schedules[channel].next_due = now; // read everything on the next pass
+	}
+	bumper_samples = 0;
+	passes = 0;
+	report_start = now;
+	report_end = now;
+}
@@ -0,0 +1,42 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (adaptive sampling)
+
+Reading every analog sensor on every pass of the main loop wastes most of the readings: the photo values change
+slowly, and an IR value far from its threshold can't trigger anything soon.  With adaptive_sampling turned on,
+read_sensors() asks this planner which channels are due and only reads those:
+
+	IR		every pass while the reading is within IR_URGENT_MARGIN of avoid_threshold or approach_threshold,
+			slowing down to every IR_CALM_PERIOD_MS as it moves IR_CALM_MARGIN or more away from both
+	photo	every PHOTO_ACTIVE_PERIOD_MS, or every PHOTO_CRUISE_PERIOD_MS while cruising or stopped
+	bumpers	every pass, always
+
+A channel whose filter has not yet filled its window (after starting, or after a new filter setting) is read every
+pass until it has, so ready_to_decide() doesn't wait on the slow rates.
+
+The planner counts the readings of each channel so the achieved rates can be reported.
+*/
+
+#ifndef RE_SAMPLING_H
+#define RE_SAMPLING_H
+
+#include "RE_Engine.h"
+
+#define IR_URGENT_MARGIN 150		// IR readings this close to a threshold are read every pass
+#define IR_CALM_MARGIN 800			// IR readings this far from both thresholds are read at the calm rate
+#define IR_URGENT_MARGIN_MM 50		// the same two margins for thresholds set as distances (see RE_Calibration.h)
+#define IR_CALM_MARGIN_MM 300
+#define IR_CALM_PERIOD_MS 20		// the slowest IR rate
+#define PHOTO_ACTIVE_PERIOD_MS 20	// photo rate while seeking, avoiding, approaching or escaping
+#define PHOTO_CRUISE_PERIOD_MS 100	// photo rate while cruising or stopped
+#define SAMPLING_REPORT_PATH "sampling_report.txt"
+
+extern bool adaptive_sampling; // false (the default) reads every channel on every pass
+
+bool channel_due(int channel, unsigned long now);				// true if an analog channel should be read this pass
+void channel_sampled(int channel, int value, unsigned long now); // count a reading and plan when the channel is due next
+void bumpers_sampled(unsigned long now);						// count one reading of the bumpers
+void write_sampling_report(FILE* file);							// write the readings and rate of every channel since the last reset
+void reset_sampling_report(unsigned long now);					// start counting again from now
+void make_channels_due();										// read every analog channel on the next pass, whatever its rate
+
+#endif
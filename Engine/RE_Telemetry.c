@@ -0,0 +1,155 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (live telemetry)
+
+See RE_Telemetry.h for the targets and the frame layout.
+
+open_telemetry() works out the address and opens the socket once, so publishing is filling in the static frame and
+one sendto() with MSG_DONTWAIT.  Opening and closing links can happen on any thread; swap_telemetry() and
+publish_telemetry() run on the main loop.
+
+Course:			211 - Perception & Action
+Instructors:	Ken Livingston, Joshua de Leeuw
+*/
+
+#include "RE_Telemetry.h"
+#include "RE_Calibration.h"
+#include <string.h>		// library for taking the target apart
+#include <unistd.h>		// library for closing the socket
+#include <sys/socket.h> // library for the datagram socket
+#include <sys/un.h>		// library for Unix socket addresses
+#include <netinet/in.h> // library for UDP addresses
+#include <arpa/inet.h>	// library for reading dotted IP addresses
+
+struct telemetry_link
+{
+	int socket;
+	struct sockaddr_storage address;
+	socklen_t length;
+};
+
+static telemetry_link* current_link = NULL;		 // NULL while telemetry is off
+static telemetry_frame frame = {.magic = TELEMETRY_MAGIC}; // filled in place and sent as it is
+static unsigned long last_sent_time;
+static telemetry_stats stats;
+
+/* WORK OUT THE ADDRESS OF A TARGET, RETURNS THE SOCKET FAMILY OR -1 IF IT IS NOT UNDERSTOOD */
+static int parse_target(const char* target, struct sockaddr_storage* address, socklen_t* length)
+{
+	memset(address, 0, sizeof(*address));
+	if (strncmp(target, "unix:", 5) == 0)
+	{
+		struct sockaddr_un* unix_address = (struct sockaddr_un*)address;
+		const char* path = target + 5;
+		if (path[0] == '\0' || strlen(path) >= sizeof(unix_address->sun_path))
+			return -1;
+		unix_address->sun_family = AF_UNIX;
+		strcpy(unix_address->sun_path, path);
+		*length = sizeof(struct sockaddr_un);
+		return AF_UNIX;
+	}
+	if (strncmp(target, "udp:", 4) == 0)
+	{
+		char host[64];
+		const char* colon = strrchr(target + 4, ':');
+		size_t host_length = (colon != NULL) ? (size_t)(colon - (target + 4)) : 0;
+		if (host_length == 0 || host_length >= sizeof(host))
+			return -1;
+		memcpy(host, target + 4, host_length);
+		host[host_length] = '\0';
+
+		struct sockaddr_in* udp_address = (struct sockaddr_in*)address;
+		char* end;
+		long port = strtol(colon + 1, &end, 10);
+		if (*end != '\0' || port <= 0 || port > 65535 || inet_pton(AF_INET, host, &udp_address->sin_addr) != 1)
+			return -1;
+		udp_address->sin_family = AF_INET;
+		udp_address->sin_port = htons((uint16_t)port);
+		*length = sizeof(struct sockaddr_in);
+		return AF_INET;
+	}
+	return -1;
+}
+
+telemetry_link* open_telemetry(const char* target, bool* ok)
+{
+	*ok = true;
+	if (strcmp(target, "off") == 0)
+		return NULL;
+
+	telemetry_link* link = malloc(sizeof(telemetry_link));
+	int family = (link != NULL) ? parse_target(target, &link->address, &link->length) : -1;
+	if (family >= 0)
+		link->socket = socket(family, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+	if (family < 0 || link->socket < 0)
+	{
+		free(link);
+		*ok = false;
+		return NULL;
+	}
+	return link;
+}
+
+telemetry_link* swap_telemetry(telemetry_link* link)
+{
+	telemetry_link* previous = current_link;
+	current_link = link;
+	return previous;
+}
+
+void close_telemetry(telemetry_link* link)
+{
+	if (link == NULL)
+		return;
+	close(link->socket);
+	free(link);
+}
+
+bool start_telemetry(const char* target)
+{
+	bool ok;
+	close_telemetry(swap_telemetry(open_telemetry(target, &ok)));
+	return ok;
+}
+
+void publish_telemetry()
+{
+	if (current_link == NULL)
+		return;
+	unsigned long now = systime();
+	if (now - last_sent_time < TELEMETRY_PERIOD_MS)
+		return;
+	last_sent_time = now;
+
+	frame.sequence++;
+	frame.time = (uint32_t)now;
+	frame.analog[RIGHT_PHOTO_CHANNEL] = (int16_t)right_photo_value;
+	frame.analog[LEFT_PHOTO_CHANNEL] = (int16_t)left_photo_value;
+	frame.analog[RIGHT_IR_CHANNEL] = (int16_t)right_ir_value;
+	frame.analog[LEFT_IR_CHANNEL] = (int16_t)left_ir_value;
+	frame.right_ir_mm = (int16_t)(ir_calibrated ? right_ir_mm : -1);
+	frame.left_ir_mm = (int16_t)(ir_calibrated ? left_ir_mm : -1);
+
+	int i;
+	frame.front_bumps = 0;
+	frame.back_bumps = 0;
+	for (i = 0; i < MAX_BUMPERS; i++)
+	{
+		frame.front_bumps |= (front_bump_values[i] == 1) << i;
+		frame.back_bumps |= (back_bump_values[i] == 1) << i;
+	}
+	frame.conditions = (uint8_t)current_conditions; // what the last decision saw, rather than sensing again
+	frame.behavior = (int8_t)current_behavior;
+	frame.action_ms = (uint16_t)timer_duration;
+	frame.photo_age_ms = (uint8_t)((now - photo_pair_time < 255) ? now - photo_pair_time : 255);
+	frame.ir_age_ms = (uint8_t)((now - ir_pair_time < 255) ? now - ir_pair_time : 255);
+
+	if (sendto(current_link->socket, &frame, sizeof(frame), MSG_DONTWAIT, (struct sockaddr*)&current_link->address, current_link->length) == sizeof(frame))
+		stats.sent++;
+	else
+		stats.dropped++; // the socket is full, or nobody is listening yet: never wait for it
+}
+
+telemetry_stats get_telemetry_stats()
+{
+	return stats;
+}
@@ -0,0 +1,62 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (live telemetry)
+
+Sends what the robot senses and decides to a laptop while it runs, so the sensor values and the behavior that is
+driving can be watched live instead of read off the robot's screen.  Tools/re_telemetry.c receives and prints them.
+
+The target is set with the "telemetry" line of the configuration file (see RE_Config.h):
+
+	telemetry udp:192.168.125.2:5005	# UDP datagrams to a laptop on the robot's network
+	telemetry unix:/tmp/re_telemetry	# Unix datagrams to a receiver on the robot itself
+	telemetry off
+
+Each frame is a telemetry_frame sent as it is in memory (both the Wombat and a laptop are little-endian), filled in
+place in one static frame, so publishing needs no allocation and no formatting.  The socket never blocks: if the
+network or the receiver can't keep up, the frame is dropped and counted, and the robot carries on.
+
+Opening the socket is left to whoever calls open_telemetry(), which the configuration watcher does on its own
+thread; the main loop only swaps the open link in.
+*/
+
+#ifndef RE_TELEMETRY_H
+#define RE_TELEMETRY_H
+
+#include "RE_Engine.h"
+#include <stdint.h> // library for the fixed-width frame fields
+
+#define TELEMETRY_MAGIC 0x31544552u // "RET1" in the first four bytes, so a receiver can tell our frames apart
+#define TELEMETRY_PERIOD_MS 20		// at most one frame every this many milliseconds
+#define TELEMETRY_TARGET_LENGTH 108 // the longest target, enough for a Unix socket path
+
+typedef struct telemetry_frame
+{
+	uint32_t magic;					  // TELEMETRY_MAGIC
+	uint32_t sequence;				  // counts up by one per frame sent or dropped, so a receiver can see the gaps
+	uint32_t time;					  // systime() when the frame was filled (ms)
+	int16_t analog[ANALOG_CHANNEL_COUNT]; // the filtered readings, indexed by channel
+	int16_t right_ir_mm, left_ir_mm;  // -1 unless the IR sensors are calibrated
+	uint8_t front_bumps, back_bumps;  // one bit per bumper, in the order of the pin map
+	uint8_t conditions;				  // the condition bits the last decision was made for
+	int8_t behavior;				  // current_behavior
+	uint16_t action_ms;				  // how long the current action drives for
+	uint8_t photo_age_ms, ir_age_ms;  // how long before [time] each pair was read (the middle of its burst), 255 for that long or longer
+} telemetry_frame;
+
+_Static_assert(sizeof(telemetry_frame) == 32, "the telemetry frame layout is shared with the receiver");
+
+typedef struct telemetry_stats
+{
+	unsigned long sent;	   // frames handed to the network
+	unsigned long dropped; // frames the socket would have had to wait for
+} telemetry_stats;
+
+typedef struct telemetry_link telemetry_link; // an open socket and the address to send to
+
+telemetry_link* open_telemetry(const char* target, bool* ok);	// open a link to "udp:HOST:PORT" or "unix:PATH", NULL for "off"; [ok] is false if the target is not understood
+telemetry_link* swap_telemetry(telemetry_link* link);			// send frames over [link] from now on (NULL stops), returns the link used until now
+void close_telemetry(telemetry_link* link);						// close a link that is no longer in use (NULL does nothing)
+bool start_telemetry(const char* target);						// open, swap and close in one go, returns false if the target is not understood
+void publish_telemetry();				  // send a frame of the current values, if TELEMETRY_PERIOD_MS has passed since the last one
+telemetry_stats get_telemetry_stats();	  // how many frames were sent and dropped so far
+
+#endif
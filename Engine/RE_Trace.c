@@ -0,0 +1,162 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (span tracer)
+
+See RE_Trace.h for how it is used.
+
+Every thread that records claims one of the buffers below the first time it records, and from then on is the only
+one writing to it.  Each buffer is a ring: event n goes in slot n % TRACE_EVENTS_PER_THREAD, overwriting event
+n - TRACE_EVENTS_PER_THREAD.  Two atomic counts that only go up (and wrap, which is why the size is a power of two)
+say how many events were started and how many are complete.  write_trace() copies the complete ones while the
+thread keeps going, then reads the started count and throws away the oldest copies the thread may have been
+overwriting in the meantime.
+
+Course:			211 - Perception & Action
+Instructors:	Ken Livingston, Joshua de Leeuw
+*/
+
+#include "RE_Trace.h"
+
+#ifdef RE_TRACE
+
+#include <stdio.h>	   // library for writing the trace file
+#include <stdbool.h>   // library for boolean support
+#include <stdint.h>	   // library for the 64-bit timestamps
+#include <stdatomic.h> // library for claiming buffers and publishing events without locking
+#include <time.h>	   // library for the microsecond clock
+
+_Static_assert((TRACE_EVENTS_PER_THREAD & (TRACE_EVENTS_PER_THREAD - 1)) == 0, "the ring indexes by masking the count");
+
+typedef struct trace_record
+{
+	_Atomic(const char*) name; // a string literal, so only the pointer is stored
+	_Atomic(uint64_t) time;	   // nanoseconds since boot, shifted left one bit, with the low bit set for the end of a span
+} trace_record;
+
+typedef struct trace_buffer
+{
+	const char* thread_name;
+	atomic_uint started;  // events whose slot has been claimed, including the ones since overwritten
+	atomic_uint complete; // events that are fully written
+	trace_record events[TRACE_EVENTS_PER_THREAD];
+} trace_buffer;
+
+static trace_buffer buffers[TRACE_MAX_THREADS];
+static atomic_int buffers_claimed = 0;
+static atomic_ulong events_lost = 0;				 // events recorded by a thread without a buffer
+static _Thread_local trace_buffer* my_buffer = NULL; // the buffer of the calling thread, once it has one
+
+typedef struct trace_copy
+{
+	const char* name;
+	uint64_t time;
+} trace_copy;
+
+static trace_copy snapshot[TRACE_EVENTS_PER_THREAD]; // write_trace copies one buffer here before writing it out
+
+/* THE BUFFER OF THE CALLING THREAD, CLAIMING ONE THE FIRST TIME; NULL IF THEY ARE ALL TAKEN */
+static trace_buffer* thread_buffer()
+{
+	if (my_buffer == NULL)
+	{
+		int index = atomic_fetch_add(&buffers_claimed, 1);
+		if (index >= TRACE_MAX_THREADS)
+			return NULL; // keeps claiming (and failing) on every call, but only for threads beyond the limit
+		my_buffer = &buffers[index];
+	}
+	return my_buffer;
+}
+
+void trace_event(const char* name, char phase)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	trace_buffer* buffer = thread_buffer();
+	if (buffer == NULL)
+	{
+		atomic_fetch_add(&events_lost, 1);
+		return;
+	}
+
+	unsigned int count = atomic_load_explicit(&buffer->complete, memory_order_relaxed);
+	trace_record* record = &buffer->events[count & (TRACE_EVENTS_PER_THREAD - 1)];
+	atomic_store_explicit(&buffer->started, count + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release); // anyone who sees the new record also sees that its slot was claimed
+	atomic_store_explicit(&record->name, name, memory_order_relaxed);
+	atomic_store_explicit(&record->time, (((uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec) << 1) | (phase == 'E'), memory_order_relaxed);
+	atomic_store_explicit(&buffer->complete, count + 1, memory_order_release); // publish it to write_trace
+}
+
+void trace_thread_name(const char* name)
+{
+	trace_buffer* buffer = thread_buffer();
+	if (buffer != NULL)
+		buffer->thread_name = name;
+}
+
+/* COPY THE EVENTS A BUFFER STILL HOLDS INTO snapshot, RETURNS HOW MANY, SETS [first] TO THE OLDEST ONE THAT IS SURE
+TO BE INTACT AND ADDS THE OVERWRITTEN ONES TO [lost] */
+static unsigned int copy_buffer(trace_buffer* buffer, unsigned int* first, unsigned long* lost)
+{
+	unsigned int complete = atomic_load_explicit(&buffer->complete, memory_order_acquire);
+	unsigned int held = (complete < TRACE_EVENTS_PER_THREAD) ? complete : TRACE_EVENTS_PER_THREAD;
+	unsigned int i;
+	for (i = 0; i < held; i++)
+	{
+		trace_record* record = &buffer->events[(complete - held + i) & (TRACE_EVENTS_PER_THREAD - 1)];
+		snapshot[i].name = atomic_load_explicit(&record->name, memory_order_relaxed);
+		snapshot[i].time = atomic_load_explicit(&record->time, memory_order_relaxed);
+	}
+	atomic_thread_fence(memory_order_acquire);
+
+	unsigned int overwritten = atomic_load_explicit(&buffer->started, memory_order_relaxed) - complete; // slots the thread claimed while we copied
+	*first = (overwritten < held) ? overwritten : held;
+	*lost += complete - held + *first;
+	return held;
+}
+
+void write_trace(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+		return;
+
+	fprintf(file, "{\"traceEvents\":[\n");
+	bool first = true;
+	unsigned long lost = atomic_load(&events_lost);
+	int claimed = atomic_load(&buffers_claimed);
+	int thread;
+	for (thread = 0; thread < claimed && thread < TRACE_MAX_THREADS; thread++)
+	{
+		trace_buffer* buffer = &buffers[thread];
+		if (buffer->thread_name != NULL)
+		{
+			fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+					first ? "" : ",\n", thread, buffer->thread_name);
+			first = false;
+		}
+
+		unsigned int i;
+		unsigned int count = copy_buffer(buffer, &i, &lost);
+		int depth = 0; // spans open at this point of the copy
+		for (; i < count; i++)
+		{
+			const char* name = snapshot[i].name;
+			uint64_t time = snapshot[i].time;
+			bool end = time & 1;
+			if (end && depth == 0)
+				continue; // its beginning was overwritten
+			depth += end ? -1 : 1;
+
+			uint64_t nanoseconds = time >> 1;
+			fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%llu.%03u}",
+					first ? "" : ",\n", name, end ? 'E' : 'B', thread,
+					(unsigned long long)(nanoseconds / 1000), (unsigned)(nanoseconds % 1000)); // ts is in microseconds
+			first = false;
+		}
+	}
+	fprintf(file, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"events_overwritten\":\"%lu\"}}\n", lost);
+	fclose(file);
+}
+
+#endif
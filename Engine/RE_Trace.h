@@ -0,0 +1,51 @@
+/*
+Vassar Cognitive Science - Robot Ethology Engine (span tracer)
+
+Averages hide the one slow pass that made the robot hit a wall.  The tracer records when each traced piece of work
+(reading the sensors, each perception check, arbitration, driving, drawing the gui) begins and ends, on every
+thread, and writes them out as a Chrome trace-event file.  Open it in chrome://tracing or ui.perfetto.dev to see
+each pass of the main loop on a timeline, next to whatever the display thread was doing at the same moment.
+
+Tracing is compiled out unless RE_TRACE is defined, either below or with -DRE_TRACE, so the robot pays nothing for
+it normally.  When it is on, each thread records into its own buffer that is allocated before the robot starts, so
+recording a span is a clock read and two stores with no locking.  Each buffer is a ring that keeps the most recent
+TRACE_EVENTS_PER_THREAD events, so a trace written when the gui opens shows the last few seconds of operating
+rather than the first (the count of events that were overwritten is written into the file).
+
+	TRACE_BEGIN("read_sensors");
+	read_sensors();
+	TRACE_END("read_sensors");
+	...
+	TRACE_WRITE(TRACE_PATH);
+*/
+
+#ifndef RE_TRACE_H
+#define RE_TRACE_H
+
+// #define RE_TRACE // uncomment to record spans
+
+#define TRACE_PATH "trace.json"
+#define TRACE_MAX_THREADS 4			 // threads that can record (main loop, display, configuration watcher, one spare)
+#define TRACE_EVENTS_PER_THREAD 32768 // the most recent begins and ends each thread keeps, 16 bytes each; a power of two
+
+#ifdef RE_TRACE
+
+void trace_event(const char* name, char phase); // record the beginning ('B') or end ('E') of a span on this thread
+void trace_thread_name(const char* name);		// name this thread in the trace
+void write_trace(const char* path);				// write the events each thread still holds as Chrome trace-event JSON
+
+#define TRACE_BEGIN(name) trace_event(name, 'B')
+#define TRACE_END(name) trace_event(name, 'E')
+#define TRACE_THREAD(name) trace_thread_name(name)
+#define TRACE_WRITE(path) write_trace(path)
+
+#else
+
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name) ((void)0)
+#define TRACE_THREAD(name) ((void)0)
+#define TRACE_WRITE(path) ((void)0)
+
+#endif
+
+#endif
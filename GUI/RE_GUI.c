@@ -12,233 +12,256 @@ Date:			August 2022
 // *** Import Libraries *** //
 
 // #include <kipr/wombat.h> // KIPR Wombat native library
-#include <stdlib.h>	 // library for general purpose functions
-#include <stdbool.h> // library for boolean support
+#include "RE_Engine.h" // the shared Robot Ethology engine: sensors, actions, behaviors and the hierarchy
+#include "RE_GUI.h"	   // what this program shares with the scripted runs of Tools/re_gui_headless.c
+#include "RE_Config.h" // thresholds, speeds and hierarchy from a configuration file
+#include "RE_Display.h" // drawing the screen from a separate thread so the robot doesn't wait for it
+#include "RE_Sampling.h" // how often each sensor was read while operating
+#include "RE_Trace.h"	 // timelines of the main loop and display thread, when RE_TRACE is defined
+#include "RE_Telemetry.h" // live sensor values and decisions for a laptop, when the configuration file sets a target
+#include "RE_Log.h"		  // a compact log of each stretch of operating, when the configuration file turns it on
 
 // *** Define PIN Address *** //
 
-#define RIGHT_IR_PIN 0
-#define LEFT_IR_PIN 1
-#define RIGHT_PHOTO_PIN 2
-#define LEFT_PHOTO_PIN 3 // analog sensors (IRs, photos)
-
-#define FRONT_BUMP_CENTER_PIN 2
-#define FRONT_BUMP_SIDE_PIN 3
-#define BACK_BUMP_CENTER_PIN 0
-#define BACK_BUMP_SIDE_PIN 1 // digital sensors (bumpers)
-
-#define RIGHT_MOTOR_PIN 0
-#define LEFT_MOTOR_PIN 1 // servos
+const pin_map robot_pins = {
+	0, 1, 2, 3, // right IR, left IR, right photo, left photo (analog)
+	{2, 3}, 2,	// front bumpers: center, side (digital)
+	{0, 1}, 2,	// back bumpers: center, side (digital)
+	0, 1,		// right motor, left motor (servos)
+	0, 2047};	// servo positions for full speed backward and forward
 
+#define DECISION_TABLE_PATH "decision_table.txt" // where the decision table is written each time we start operating or apply a configuration
 
 // *** Function Declarations *** //
 
-// PERCEPTION FUNCTIONS
-void read_sensors();							 // read all sensor values and save to global variables
-bool is_above_distance_threshold(int threshold); // return true if one and only one IR sensor is above the specified threshold
-bool is_above_photo_differential(int threshold); // return true if the absolute difference between photo sensor values is above the specified threshold
-bool is_front_bump();							 // return true if one of the front bumpers was hit
-bool is_back_bump();							 // return true if one of the back bumpers was hit
-bool timer_elapsed();							 // return true if our timer has elapsed
-
-// ACTION FUNCTIONS
-void escape_front();
-void escape_back();
-void seek_light();
-void seek_dark();
-void avoid();
-void approach();
-void cruise_straight();
-void cruise_arc();
-void stop();
-
-// MOTOR CONTROL
-void drive(float left, float right, float delay_seconds); // drive with the specified left and right motor speeds for a number of seconds
-
-// HELPER FUNCTIONS
-float map(float value, float start_range_low, float start_range_high, float target_range_low, float target_range_high); // remap a value from a source range to a new range
+// GUI FUNCTIONS
+void update_gui();												// handle queued button presses and redraw the gui when something changed
+void randomize_hierarchy();										// shuffle the hierarchy and deactivate every behavior
+void print_subsumption_hierarchy(behavior* array, size_t len); // draw the gui
+void print_set_hierarchy();										// print the active behaviors while operating
+void write_sampling_report_file();								// write how often each sensor was read since we started operating
+void sort_gui_hierarchy();										// sort the hierarchy by rank and count the sort
 
 // BUILT-IN FUNCTIONS
-void enable_servo(int pin);						// enable servo at the specified pin
-int analog_et(int pin);							// get the 10-bit analog value of a sensor on the specified pin
-int digital(int pin);							// get the digital value of a sensor on the specified pin
-unsigned long systime();						// get the system time
-void set_servo_position(int pin, int position); // set a servo at the specified pin to the specified position
+int any_button();							   // return 1 if any button is currently held down
+int side_button();							   // return 1 while the white side button is held down
+int a_button();								   // return 1 while the A button is held down (likewise for the other buttons below)
+int b_button();
+int c_button();
+int x_button();
+int y_button();
+int z_button();
+void set_a_button_text(const char* text);	   // set the label of the A button (likewise for the other buttons below)
+void set_b_button_text(const char* text);
+void set_c_button_text(const char* text);
+void set_x_button_text(const char* text);
+void set_y_button_text(const char* text);
+void set_z_button_text(const char* text);
+void set_extra_buttons_visible(int visible);   // show (1) or hide (0) the X, Y and Z buttons
 
 // *** Variable Definitions *** //
 
-// global variables to store all current sensor values accessible to all functions and updated by the "read_sensors" function
-int right_photo_value, left_photo_value, right_ir_value, left_ir_value, front_bump_center_value, front_bump_side_value, back_bump_center_value, back_bump_side_value;
-
-// threshold values
-int avoid_threshold = 1600;	   // the absolute difference between IR readings has to be above this for the avoid action
-int approach_threshold = 1600; // the absolute difference between IR readings has to be below this for the approach action
-int photo_threshold = 150;	   // the absolute difference between photo sensor readings has to be above this for seek light/dark actions
+int cursor_row = 0;					   // the row that the cursor is on in gui mode
+bool show_gui = false;				   // boolean toggled by pushing the white side button on the kipr link
+bool first_gui = true;				   // on first exposure to gui, we randomize the hierarchy so the initialized behavior can't be observed
+bool is_side_update = false;		   // sort on button press
+bool update_operating_console = false; // a boolean to tell us when to update the operating console, preventing us from constantly reprinting and clearing, which results in flicker
+bool start_operating = true;		   // true at power-on and when the gui is closed: a new stretch of operating starts, with its own report and log
+bool config_hierarchy_loaded = false;  // once the configuration file sets the hierarchy, the gui keeps it instead of randomizing
 
-// timer
-int timer_duration = 500;	  // the time in milliseconds to wait between calling action commands, changed by each drive command called by actions
-unsigned long start_time = 0; // store the system time each time we start an action so we can see if our time has elapsed without a blocking delay
+gui_counts gui_work = {0, 0, 0, 0}; // see RE_GUI.h
 
 //==============================================//
 //===============GUI RELATED CODE===============//
 //==============================================//
 
-// Define GUI-related action types
-#define SEEK_LIGHT_TYPE 0
-#define SEEK_DARK_TYPE 1
-#define APPROACH_TYPE 2
-#define AVOID_TYPE 3
-#define ESCAPE_F_TYPE 4
-#define ESCAPE_B_TYPE 5
-#define CRUISE_S_TYPE 6
-#define CRUISE_A_TYPE 7
+//===============BUTTON INPUT===============//
 
 /*
-Here, we define new kind of variable type called "behavior" that contains properties for type (indexing definitions above), rank, and an active/inactive boolean.
+Instead of asking the library whether each button was clicked (one call per button per loop, and only one press
+handled per loop), we sample all buttons once per frame into a bitmask and turn every change into a press or
+release event.  The events wait in a small ring queue until update_gui() drains them, so simultaneous presses
+are all handled in the order of the bits below.
 */
-typedef struct behavior
+#define SIDE_BUTTON_BIT (1 << 0)
+#define C_BUTTON_BIT (1 << 1)
+#define Z_BUTTON_BIT (1 << 2)
+#define A_BUTTON_BIT (1 << 3)
+#define B_BUTTON_BIT (1 << 4)
+#define Y_BUTTON_BIT (1 << 5)
+#define X_BUTTON_BIT (1 << 6)
+#define BUTTON_COUNT 7
+
+#define BUTTON_EVENT_QUEUE_SIZE 16 // must be a power of two; a frame can produce at most 2 * BUTTON_COUNT events
+
+typedef struct button_event
 {
-	const char* title;
-	int type;
-	int rank;
-	bool is_active;
-} behavior;
-
-/*
-This struct defines the initial behavior, but also describes all possible behaviors.
-New ones could be added, or the order can be moved around.
-This behavior runs once at the beginning of the program until the gui is accessed.
-There is no need to change the rank value manually, just change the order and set
-the ones you want to be active to "true".  The element at the top is at the top of the hierarchy.
-*/
-struct behavior subsumption_hierarchy[] = {
-	{"ESCAPE FRONT", ESCAPE_F_TYPE, 0, true},
-	{"ESCAPE BACK", ESCAPE_B_TYPE, 0, true},
-	{"AVOID", AVOID_TYPE, 0, true},
-	{"SEEK LIGHT", SEEK_LIGHT_TYPE, 0, true},
-	{"CRUISE STRAIGHT", CRUISE_S_TYPE, 0, true},
-	{"SEEK DARK", SEEK_DARK_TYPE, 0, false},
-	{"APPROACH", APPROACH_TYPE, 0, false},
-	{"CRUISE ARC", CRUISE_A_TYPE, 0, false} };
+	int button;	  // one of the *_BUTTON_BIT values above
+	bool pressed; // true when the button went down, false when it came back up
+} button_event;
 
+button_event button_events[BUTTON_EVENT_QUEUE_SIZE]; // ring queue of events waiting to be handled by update_gui
+unsigned int button_event_head = 0;					 // index of the next event to hand out
+unsigned int button_event_tail = 0;					 // index of the next free slot
+int button_state = 0;								 // bitmask of the buttons that were held down at the last sample
 
-/*
-Declare and initialize variables
-*/
-int hierarchy_length;				   // set in main function based on number of elements in subsumption_hierarchy defined above
-int cursor_row = 0;					   // the row that the cursor is on in gui mode
-bool show_gui = false;				   // boolean toggled by pushing the white side button on the kipr link
-bool first_gui = true;				   // on first exposure to gui, we randomize the hierarchy so the initialized behavior can't be observed
-bool is_side_update = false;		   // sort on button press
-bool update_operating_console = false; // a boolean to tell us when to update the operating console, preventing us from constantly reprinting and clearing, which results in flicker
-
-/*
-This comparator function is used in the qsort function for sorting our behavior list.
-Active things always go before inactive things, and if both are active then the are ordered by rank.
-*/
-int compare_ranks(const void* a, const void* b)
+/* SAMPLE ALL BUTTONS ONCE AND QUEUE WHAT CHANGED */
+void sample_buttons()
 {
-	bool is_active_a = ((struct behavior*)a)->is_active;
-	bool is_active_b = ((struct behavior*)b)->is_active;
-	if (is_active_a != is_active_b)
+	int state = 0;
+
+	if (button_state != 0 || any_button())
+	{ // when nothing is held and nothing was held last frame, the single any_button() call is the whole cost
+		if (side_button())
+			state |= SIDE_BUTTON_BIT;
+		if (c_button())
+			state |= C_BUTTON_BIT;
+		if (z_button())
+			state |= Z_BUTTON_BIT;
+		if (a_button())
+			state |= A_BUTTON_BIT;
+		if (b_button())
+			state |= B_BUTTON_BIT;
+		if (y_button())
+			state |= Y_BUTTON_BIT;
+		if (x_button())
+			state |= X_BUTTON_BIT;
+	}
+
+	int changed = state ^ button_state;
+	int i;
+	for (i = 0; i < BUTTON_COUNT && changed != 0; i++)
 	{
-		return is_active_b;
+		int bit = 1 << i;
+		if ((changed & bit) && button_event_tail - button_event_head < BUTTON_EVENT_QUEUE_SIZE)
+		{ // the queue only fills up if update_gui stops draining it; then newer events are dropped
+			button_events[button_event_tail % BUTTON_EVENT_QUEUE_SIZE].button = bit;
+			button_events[button_event_tail % BUTTON_EVENT_QUEUE_SIZE].pressed = (state & bit) != 0;
+			button_event_tail++;
+		}
 	}
-	int rank_a = ((struct behavior*)a)->rank;
-	int rank_b = ((struct behavior*)b)->rank;
-	return (rank_a - rank_b);
+	button_state = state;
+}
+
+/* TAKE THE OLDEST EVENT OFF THE QUEUE, RETURNS FALSE WHEN THE QUEUE IS EMPTY */
+bool next_button_event(button_event* event)
+{
+	if (button_event_head == button_event_tail)
+		return false;
+	*event = button_events[button_event_head % BUTTON_EVENT_QUEUE_SIZE];
+	button_event_head++;
+	return true;
 }
 
 /* MANAGE GUI UPDATE */
 void update_gui()
 {
-	if (side_button_clicked())
-	{
-		show_gui = !show_gui;			 // toggle our gui by pressing the side button
-		is_side_update = show_gui;		 // boolean to do certain behaviors once at button press
-		update_operating_console = true; // boolean to update the home console once
-	}
+	bool cursor_update = false;
+	bool hierarchy_update = false;
+	bool write_timeline = false; // the trace is written once the update_gui span below has ended
+	button_event event;
 
-	if (show_gui)
-	{
-		if (first_gui)
-		{
-			randomize_hierarchy(); // this only ever happens once per program
-			first_gui = false;
-		}
-
-		bool cursor_update = false;
-		bool hierarchy_update = false;
+	TRACE_BEGIN("update_gui");
+	sample_buttons(); // read the buttons once for this frame
 
-		set_extra_buttons_visible(1); // we turn off the extra buttons (buttons xyz) when we are not in showgui mode, so we need to activate them here
+	while (next_button_event(&event))
+	{
+		gui_work.dispatches++;
+		if (!event.pressed)
+			continue; // releases only matter for detecting the next press
 
-		set_a_button_text(subsumption_hierarchy[cursor_row].is_active ? "Deactivate" : "Activate"); // set text to display activate or deactivate based on the behavior the cursor is on
-		set_b_button_text(subsumption_hierarchy[cursor_row].is_active ? "Move Up" : "");			// set text to display "move up" or nothing based on the behavior the cursor is on
-		set_y_button_text(subsumption_hierarchy[cursor_row].is_active ? "Move Down" : "");			// set text to display "move down" or nothing based on the behavior the cursor is on
+		if (event.button == SIDE_BUTTON_BIT)
+		{
+			show_gui = !show_gui;			 // toggle our gui by pressing the side button
+			is_side_update = show_gui;		 // boolean to do certain behaviors once at button press
+			update_operating_console = true; // boolean to update the home console once
+			start_operating = !show_gui;
 
-		set_c_button_text("\u25B2"); // up triangle unicode
-		set_z_button_text("\u25BC"); // unicode down triangle
+			if (show_gui && first_gui && !config_hierarchy_loaded)
+			{
+				randomize_hierarchy(); // this only ever happens once per program
+				first_gui = false;
+				hierarchy_update = true; // the decision table needs the new order
+			}
+			if (show_gui)
+			{
+				write_sampling_report_file(); // the robot stops operating, so report how often it read each sensor
+				close_session_log();
+				write_timeline = true;		  // and, when tracing, the timeline so far
+			}
+			continue;
+		}
 
-		set_x_button_text("Reset"); // reset button for deactivating all
+		if (!show_gui)
+			continue; // the other buttons only do something in the gui
 
-		if (c_button_clicked())
-		{								   // move the cursor up
+		bool ranks_changed = true; // every button but the cursor ones changes the order
+		switch (event.button)
+		{
+		case C_BUTTON_BIT:				   // move the cursor up
 			cursor_row = (cursor_row - 1); // up cursor
 			if (cursor_row < 0)
 				cursor_row += hierarchy_length; // if we go past zero, loop back to the end of the list
 			cursor_row = cursor_row % hierarchy_length;
 			cursor_update = true; // we've updated
-		}
+			ranks_changed = false;
+			break;
 
-		else if (z_button_clicked())
-		{													  // move cursor down
+		case Z_BUTTON_BIT:									  // move cursor down
 			cursor_row = (cursor_row + 1) % hierarchy_length; // move cursor down and use modulus function to loop back to zero if we go down too far
 			cursor_update = true;
-		}
+			ranks_changed = false;
+			break;
 
-		else if (a_button_clicked())
-		{																								// activate or deactivate button
+		case A_BUTTON_BIT:																				// activate or deactivate button
 			subsumption_hierarchy[cursor_row].is_active = !subsumption_hierarchy[cursor_row].is_active; // toggle our active state
-			hierarchy_update = true;
-		}
+			break;
 
-		else if (b_button_clicked())
-		{
+		case B_BUTTON_BIT:
 			subsumption_hierarchy[cursor_row].rank -= 2; // move up
-			hierarchy_update = true;
-		}
+			break;
 
-		else if (y_button_clicked())
-		{
+		case Y_BUTTON_BIT:
 			subsumption_hierarchy[cursor_row].rank += 2; // move down
-			hierarchy_update = true;
-		}
+			break;
 
-		else if (x_button_clicked())
-		{ // reset all button
+		case X_BUTTON_BIT: // reset all button
+		{
 			size_t i;
 			for (i = 0; i < hierarchy_length; i++)
 			{
 				subsumption_hierarchy[i].is_active = false;
 			}
+			break;
+		}
+		}
+
+		if (ranks_changed)
+		{ // re-sort right away so a second press in the same frame sees the new order under the cursor
+			sort_gui_hierarchy();
 			hierarchy_update = true;
 		}
+	}
+
+	if (show_gui)
+	{
+		set_extra_buttons_visible(1); // we turn off the extra buttons (buttons xyz) when we are not in showgui mode, so we need to activate them here
+
+		set_a_button_text(subsumption_hierarchy[cursor_row].is_active ? "Deactivate" : "Activate"); // set text to display activate or deactivate based on the behavior the cursor is on
+		set_b_button_text(subsumption_hierarchy[cursor_row].is_active ? "Move Up" : "");			// set text to display "move up" or nothing based on the behavior the cursor is on
+		set_y_button_text(subsumption_hierarchy[cursor_row].is_active ? "Move Down" : "");			// set text to display "move down" or nothing based on the behavior the cursor is on
+
+		set_c_button_text("\u25B2"); // up triangle unicode
+		set_z_button_text("\u25BC"); // unicode down triangle
+
+		set_x_button_text("Reset"); // reset button for deactivating all
 
 		if (cursor_update || is_side_update || hierarchy_update)
 		{ // if we pressed anything at all
 
-			qsort(subsumption_hierarchy, hierarchy_length, sizeof(behavior), compare_ranks); // sort our hierarchy based on rank value
-
-			size_t i;
-			for (i = 0; i < hierarchy_length; i++)
-			{
-				if (subsumption_hierarchy[i].is_active)
-					subsumption_hierarchy[i].rank = i; // now reset the index of each sorted active behavior to be sequential with a step size of one
-				else
-					subsumption_hierarchy[i].rank = hierarchy_length + 1; // give inactive behaviors a constant "poor" rank which is helpful to ensure new ones always jump above.
-			}
+			if (hierarchy_update)
+				compile_decision_table(); // the winning behaviors may have changed; the order is already sorted above
 
-			console_clear();													  // clear the console
 			print_subsumption_hierarchy(subsumption_hierarchy, hierarchy_length); // print the hierarchy and interface
 			is_side_update = false;												  // turn off the is_side_update boolean so we don't get screen flicker until we update the cursor or hierarchy next
 		}
@@ -250,7 +273,11 @@ void update_gui()
 		set_c_button_text("");
 		set_extra_buttons_visible(0);
 	}
+	TRACE_END("update_gui");
+	if (write_timeline)
+		TRACE_WRITE(TRACE_PATH);
 }
+
 /* RANDOMIZE HIERARCHY AND DEACTIVATE ALL */
 void randomize_hierarchy()
 {
@@ -260,54 +287,82 @@ void randomize_hierarchy()
 		subsumption_hierarchy[i].is_active = false;
 		subsumption_hierarchy[i].rank = rand();
 	}
-	qsort(subsumption_hierarchy, hierarchy_length, sizeof(behavior), compare_ranks); // sort our hierarchy based on rank value
+	sort_gui_hierarchy(); // sort our hierarchy based on rank value
+}
+
+/* SORT THE HIERARCHY BY RANK */
+void sort_gui_hierarchy()
+{
+	sort_hierarchy(subsumption_hierarchy, hierarchy_length);
+	gui_work.sorts++;
 }
 
 /* MANAGE SCREEN PRINTING OF GUI */
-void print_subsumption_hierarchy(struct behavior* array, size_t len)
+void print_subsumption_hierarchy(behavior* array, size_t len)
 {
+	TRACE_BEGIN("print_subsumption_hierarchy");
+	display_frame* frame = begin_frame(); // start from a clear screen
 	size_t i;
 	for (i = 0; i < len; i++)
 	{
-		display_printf(1, i, "%s          ", array[i].title);
+		frame_printf(frame, 1, i, "%s          ", behavior_registry[array[i].type].title);
 		if (array[i].is_active)
 		{
-			display_printf(17, i, "Active  ");
+			frame_printf(frame, 17, i, "Active  ");
 		}
 		else
 		{
-			display_printf(17, i, "Inactive ");
+			frame_printf(frame, 17, i, "Inactive ");
 		}
 		if (i == cursor_row)
 		{
-			display_printf(0, i, ">");
-			display_printf(25, i, "<");
+			frame_printf(frame, 0, i, ">");
+			frame_printf(frame, 25, i, "<");
 		}
 		else
 		{
-			display_printf(0, i, " ");
-			display_printf(25, i, " ");
+			frame_printf(frame, 0, i, " ");
+			frame_printf(frame, 25, i, " ");
 		}
-		// display_printf(35, i, "%d", array[i].rank); //debug for showing rank
+		// frame_printf(frame, 35, i, "%d", array[i].rank); //debug for showing rank
 	}
+	submit_frame(); // the display thread puts it on the screen
+	TRACE_END("print_subsumption_hierarchy");
 }
 
 /* MANAGE SCREEN PRINTING WHEN OPERATING */
 void print_set_hierarchy()
 {
-	if (update_operating_console && !first_gui)
+	if (update_operating_console)
 	{
-		console_clear();
-		size_t i;
-		for (i = 0; i < hierarchy_length; i++)
-		{
-			if (subsumption_hierarchy[i].is_active)
-				printf(" %s\n", subsumption_hierarchy[i].title);
+		TRACE_BEGIN("print_set_hierarchy");
+		if (!first_gui)
+		{ // before the gui is first opened the hierarchy is still the hidden starting one, so nothing is shown
+			display_frame* frame = begin_frame(); // start from a clear screen
+			int row = 0;
+			size_t i;
+			for (i = 0; i < hierarchy_length; i++)
+			{
+				if (subsumption_hierarchy[i].is_active)
+					frame_printf(frame, 1, row++, "%s", behavior_registry[subsumption_hierarchy[i].type].title);
+			}
+			submit_frame();
 		}
 		update_operating_console = false; // this only happens once per button press if we are not showing gui
+		TRACE_END("print_set_hierarchy");
 	}
 }
 
+/* WRITE THE SAMPLING REPORT OF THE LAST STRETCH OF OPERATING */
+void write_sampling_report_file()
+{
+	FILE* file = fopen(SAMPLING_REPORT_PATH, "w");
+	if (file == NULL)
+		return;
+	write_sampling_report(file);
+	fclose(file);
+}
+
 //===============END GUI-RELATED CODE===============//
 
 // *** Function Definitions *** //
@@ -316,252 +371,74 @@ void print_set_hierarchy()
 //===============MAIN===============//
 //==================================//
 
-int main()
-{
-	hierarchy_length = sizeof(subsumption_hierarchy) / sizeof(behavior); // set this variable once for loopin trhough the hierarchy
-
-	enable_servo(LEFT_MOTOR_PIN); // initialize both motors and set speed to zero
-	enable_servo(RIGHT_MOTOR_PIN);
-	drive(0.0, 0.0, 1.0);
-
-	while (true)
-	{				  // this is an infinite loop (true is always true)
-		update_gui(); // update our gui in any case
-
-		if (!show_gui)
-		{ // if we aren not showing the gui, we must be sensing and acting
-
-			if (update_operating_console)
-			{
-				// only enable the servos once when returning from the gui menu, this boolean is disabled in the next print_set_hierarchy function
-				enable_servo(LEFT_MOTOR_PIN);
-				enable_servo(RIGHT_MOTOR_PIN);
-				drive(0.0, 0.0, 2.0);
-			}
-			print_set_hierarchy(); // print the current subsumption hierarchy to the screen (only executes if gui has been accessed once before)
-
-			read_sensors(); // read all sensors and set global variables of their readouts
-
-			if (timer_elapsed()) // any time a drive message is called, the timer is updated; this should always return true until it is called again
-			{
-				bool execute_action = false; // tell us if we have executed ANY action
-				size_t i;					 // counter for hierarchy for loop
-				for (i = 0; i < hierarchy_length; i++)
-				{ // For each behavior in our hierarchy,
-					if (subsumption_hierarchy[i].is_active)
-					{ // if the behavior at this index is active,
-						switch (subsumption_hierarchy[i].type)
-						{ // run a switch/case to see which type this behavior is and do the appropriate action.
-						  // For the specified hierarchy type, check if we should execute the action, and do it if so.
-						  // If not, continue the for loop.  If so, execute action and break.
-						case SEEK_LIGHT_TYPE:
-							execute_action = is_above_photo_differential(photo_threshold);
-							if (execute_action)
-								seek_light();
-							break;
-						case SEEK_DARK_TYPE:
-							execute_action = is_above_photo_differential(photo_threshold);
-							if (execute_action)
-								seek_dark();
-							break;
-						case APPROACH_TYPE:
-							execute_action = is_above_distance_threshold(approach_threshold);
-							if (execute_action)
-								approach();
-							break;
-						case AVOID_TYPE:
-							execute_action = is_above_distance_threshold(avoid_threshold);
-							if (execute_action)
-								avoid();
-							break;
-						case ESCAPE_F_TYPE:
-							execute_action = is_front_bump();
-							if (execute_action)
-								escape_front();
-							break;
-						case ESCAPE_B_TYPE:
-							execute_action = is_back_bump();
-							if (execute_action)
-								escape_back();
-							break;
-						case CRUISE_S_TYPE:
-							execute_action = true;
-							cruise_straight();
-							break;
-						case CRUISE_A_TYPE:
-							execute_action = true;
-							cruise_arc();
-							break;
-						}
-					}
-					if (execute_action)
-					{
-						break; // if any action was executed, break out of the subsumption hierarchy loop altogether
-					}
-					else
-					{
-						stop(); // if there is no action, stop
-					}
-				}
-			}
-		}
-
-		else
-		{
-			disable_servos(); // disable all servo motors if we are in gui mode
-		}
-	}
-	return 0; // due to infinite while loop, we will never get here
-}
-
-//========================================//
-//===============PERCEPTION===============//
-//========================================//
-
-void read_sensors()
-{
-	right_photo_value = analog_et(RIGHT_PHOTO_PIN);			// read the photo sensor at RIGHT_PHOTO_PIN; *** NOTE: greater value means less light ***
-	left_photo_value = analog_et(LEFT_PHOTO_PIN);			// read the photo sensor at LEFT_PHOTO_PIN; *** NOTE: greater value means less light ***
-	right_ir_value = analog_et(RIGHT_IR_PIN);				// read the IR sensor at RIGHT_IR_PIN
-	left_ir_value = analog_et(LEFT_IR_PIN);					// read the IR sensor at LEFT_IR_PIN
-	// read bumpers
-	front_bump_center_value = digital(FRONT_BUMP_CENTER_PIN); 
-	front_bump_side_value = digital(FRONT_BUMP_SIDE_PIN);	
-	back_bump_center_value = digital(BACK_BUMP_CENTER_PIN);	
-	back_bump_side_value = digital(BACK_BUMP_SIDE_PIN);		
-}
-
-bool is_above_photo_differential(int threshold)
-{
-	int photo_difference = abs(right_photo_value - left_photo_value); // get the difference between the photo values
-	return photo_difference > threshold;							  // returns true if the absolute difference between photo sensors is greater than the threshold, otherwise false
-}
-
-bool is_above_distance_threshold(int threshold)
-{
-	return (left_ir_value > threshold || right_ir_value > threshold) && !(left_ir_value > threshold && right_ir_value > threshold);
-	// returns true if one (exclusive) IR value is above the threshold, otherwise false
-}
-
-bool is_front_bump()
-{
-	return (front_bump_center_value == 1 || front_bump_side_value == 1); // return true if one of the front bump values is 1, otherwise false
-}
-
-bool is_back_bump()
-{
-	return (back_bump_center_value == 1 || back_bump_side_value == 1); // return true if one of the back bump values is 1, otherwise false
-}
-
-//====================================//
-//===============ACTION===============//
-//====================================//
-
-void drive(float left, float right, float delay_seconds)
-{
-	// 850 is full motor speed clockwise, 1250 is full motor speed counterclockwise
-	// Servo is stopped from ~1044 to 1055
-
-	float left_speed = map(left, -1.0, 1.0, 0, 2047); // call the map function to map our speed (set between -1 and 1) to the appropriate range of motor values
-	float right_speed = map(right, -1.0, 1.0, 2047, 0);
-
-	timer_duration = (int)(delay_seconds * 1000.0); // multiply our desired time in seconds by 1000 to get milliseconds and update this global variable
-	start_time = systime();							// update our start time to reflect the time we start driving (in ms)
-
-	set_servo_position(LEFT_MOTOR_PIN, left_speed);
-	set_servo_position(RIGHT_MOTOR_PIN, right_speed); // set the servos to run at the mapped speed
-}
-
-void cruise_straight()
+/* REMEMBER A HIERARCHY SET BY THE CONFIGURATION FILE */
+void use_config_hierarchy()
 {
-	drive(0.50, 0.50, 0.5);
+	config_hierarchy_loaded = true;
+	first_gui = false;				 // keep the configured order instead of randomizing it when the gui opens
+	update_operating_console = true; // reprint the hierarchy that is now running
+	is_side_update = show_gui;		 // redraw the gui if it is open
 }
 
-void cruise_arc()
+/* ONE PASS OF THE MAIN LOOP */
+void run_gui_pass()
 {
-	drive(0.25, 0.4, 0.5);
-}
+	gui_work.passes++;
+	bool replaced_hierarchy;
+	if (apply_pending_config(&replaced_hierarchy))
+	{ // pick up an edited configuration file, if the watcher has parsed one
+		dump_decision_table(DECISION_TABLE_PATH); // new thresholds, speeds or order change what the table holds
+		if (replaced_hierarchy)
+			use_config_hierarchy();
+	}
+	update_gui(); // update our gui in any case
 
-void stop()
-{
-	drive(0.0, 0.0, 0.25);
-}
+	if (!show_gui)
+	{ // if we aren not showing the gui, we must be sensing and acting
 
-void escape_front()
-{
-	drive(-0.2, -0.9, 3); //drive backwards in an arc
-}
+		if (start_operating)
+		{
+			// only start the motors once at power-on and when returning from the gui menu; a configuration change keeps the same stretch of operating going
+			start_motors();
+			dump_decision_table(DECISION_TABLE_PATH); // write out the table we are about to run with, for inspection
+			reset_sampling_report(systime());		  // count sensor readings from here until the gui is opened again
+			if (session_logging)
+				start_session_log(); // log from here until the gui is opened again
+			start_operating = false;
+		}
+		print_set_hierarchy(); // print the current subsumption hierarchy to the screen (only executes if gui has been accessed once before)
 
-void escape_back()
-{
-	drive(0.9, 0.9, 1); //drive forward a little
-}
+		read_sensors(); // read all sensors and set global variables of their readouts
 
-void seek_light()
-{
-	float left_servo;
-	float right_servo;
-	int photo_difference = right_photo_value - left_photo_value;
-	if (abs(photo_difference) > photo_threshold)
-	{
-		int multiplier = (photo_difference > 0) ? 1 : -1;
-		right_servo = 0.2 * multiplier;
-		left_servo = -right_servo;
+		if (ready_to_decide()) // any time a drive message is called, the timer is updated; this returns true once it has elapsed and the sensor filters are full
+		{
+			arbitrate(); // the compiled decision table already knows which behavior wins for every combination of sensor conditions
+			gui_work.decisions++;
+		}
+		publish_telemetry(); // never waits: does nothing unless a target is set and a frame is due
+		log_frame();		 // likewise, unless a session log is open
 	}
-	drive(left_servo, right_servo, 0.25);
-}
 
-void seek_dark()
-{
-	float left_servo;
-	float right_servo;
-	int photo_difference = right_photo_value - left_photo_value;
-	if (abs(photo_difference) > photo_threshold)
+	else
 	{
-		int multiplier = (photo_difference > 1) ? -1 : 1;
-		right_servo = 0.2 * multiplier;
-		left_servo = -right_servo;
+		stop_motors(); // disable all servo motors if we are in gui mode (once)
 	}
-	drive(left_servo, right_servo, 0.25);
 }
 
-void avoid()
+// Tools/re_gui_headless.c builds this file with RE_GUI_HEADLESS defined and runs the passes itself
+#ifndef RE_GUI_HEADLESS
+int main()
 {
-	if (left_ir_value > avoid_threshold)
-	{
-		drive(0.5, -0.5, 0.1);
-	}
+	TRACE_THREAD("main loop");
+	if (load_config(CONFIG_PATH)) // read the configuration file (if there is one) and watch it for changes
+		use_config_hierarchy();
+	start_engine(&robot_pins); // start both motors and set speed to zero
+	start_display();		   // all screen output goes through the display thread from here on
 
-	else if (right_ir_value > avoid_threshold)
-	{
-		drive(-0.5, 0.5, 0.1);
-	}
-}
-
-void approach()
-{
-	if (left_ir_value > approach_threshold)
-	{
-		drive(0.1, 0.9, 0.5);
-	}
-	else if (right_ir_value > approach_threshold)
-	{
-		drive(0.9, 0.1, 0.5);
+	while (true)
+	{ // this is an infinite loop (true is always true)
+		run_gui_pass();
 	}
+	return 0; // due to infinite while loop, we will never get here
 }
-
-//=====================================//
-//===============HELPERS===============//
-//=====================================//
-
-bool timer_elapsed()
-{
-	return (systime() > (start_time + timer_duration)); // return true if the current time is greater than our start time plus timer duration
-}
-
-float map(float value, float start_range_low, float start_range_high, float target_range_low, float target_range_high)
-{
-	return target_range_low + ((value - start_range_low) / (start_range_high - start_range_low)) * (target_range_high - target_range_low);
-	// remap a value from a source range to a new range
-}
-
+#endif
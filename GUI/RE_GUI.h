@@ -0,0 +1,34 @@
+/*
+Vassar Cognitive Science - Robot Novel Behavior (GUI version)
+
+What the GUI program shares with Tools/re_gui_headless.c, which builds RE_GUI.c with RE_GUI_HEADLESS defined and
+runs its main loop passes itself.
+
+Course:			211 - Perception & Action
+Instructors:	Ken Livingston, Joshua de Leeuw
+*/
+
+#ifndef RE_GUI_H
+#define RE_GUI_H
+
+#include "RE_Engine.h"
+
+/*
+How much work the gui did, so a scripted run without the robot can compare it with an earlier run.  Screens drawn
+are counted by the display itself (get_display_stats).
+*/
+typedef struct gui_counts
+{
+	unsigned long passes;	  // times around the main loop
+	unsigned long dispatches; // button events taken off the queue by update_gui
+	unsigned long sorts;	  // times the hierarchy was sorted
+	unsigned long decisions;  // times arbitrate ran while operating
+} gui_counts;
+
+extern gui_counts gui_work;
+extern const pin_map robot_pins; // the wiring of the robot the GUI program runs
+
+void run_gui_pass();		 // one pass of the main loop: the gui, then sensing and acting unless the gui is open
+void use_config_hierarchy(); // keep the hierarchy a configuration file set, instead of randomizing one when the gui opens
+
+#endif
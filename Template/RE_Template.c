@@ -20,23 +20,16 @@ i.e. This program operates a KIPR-Wombat-based robot (equipped with analog photo
 // *** Import Libraries *** //
 
 // #include <kipr/wombat.h> // KIPR Wombat native library
-#include <stdlib.h>		 // library for general purpose functions
-#include <stdbool.h>	 // library for boolean support
+#include "RE_Engine.h" // the shared Robot Ethology engine: read_sensors, drive, timer_elapsed, map and the ready-made behaviors
 
 // *** Define PIN Address *** //
 
-#define RIGHT_PHOTO_PIN 0
-#define LEFT_PHOTO_PIN 1
-#define RIGHT_IR_PIN 2
-#define LEFT_IR_PIN 3 // analog sensors (IRs, photos)
-
-#define FRONT_BUMP_RIGHT_PIN 0
-#define FRONT_BUMP_LEFT_PIN 1
-#define BACK_BUMP_RIGHT_PIN 2
-#define BACK_BUMP_LEFT_PIN 3 // digital sensors (bumpers)
-
-#define RIGHT_MOTOR_PIN 0
-#define LEFT_MOTOR_PIN 1 // servos
+const pin_map robot_pins = {
+	2, 3, 0, 1, // right IR, left IR, right photo, left photo (analog)
+	{0, 1}, 2,	// front bumpers: right, left (digital), read into front_bump_values[0] and [1]
+	{2, 3}, 2,	// back bumpers: right, left (digital), read into back_bump_values[0] and [1]
+	0, 1,		// right motor, left motor (servos)
+	850, 1250}; // servo positions for full speed backward and forward; the servo is stopped from ~1044 to 1055
 
 /*
 ### ADD ANY OTHER SENSOR OR ACTUATOR NAMES AND THEIR PIN ADDRESSES UNDER THIS COMMENT BLOCK ###
@@ -47,31 +40,18 @@ i.e. This program operates a KIPR-Wombat-based robot (equipped with analog photo
 /*
 ### DECLARE ALL OF YOUR FUNCTIONS UNDER THIS COMMENT BLOCK, IN THEIR RESPECTIVE SECTIONS.
 What do they return (the variable type of the left) and what are their inputs (the values in the parentheses)?
+read_sensors, drive, timer_elapsed and map are already declared in RE_Engine.h.
 ###
 */
 
 // PERCEPTION FUNCTIONS
-void read_sensors();			// read all sensor values and save to global variables
 bool example_check_something(); // example perception function with no input that returns a boolean
 
 // ACTION FUNCTIONS
 int example_do_something(float foo); // example action function with a float input that returns an integer
 
 // MOTOR CONTROL
-void drive(float left, float right, float delay_seconds); // drive with the specified left and right motor speeds for a number of seconds
-void example_drive(float straight);						  // example motor control function with a float input that executes but not returning
-
-// HELPER FUNCTIONS
-bool timer_elapsed(); // return true if our timer has elapsed
-float map(float value, float start_range_low, float start_range_high, float target_range_low, float target_range_high);
-// remap a value from a source range to a new range
-
-// BUILT-IN FUNCTIONS
-void enable_servo(int pin);						// enable servo at the specified pin
-int analog_et(int pin);							// get the 10-bit analog value of a sensor on the specified pin
-int digital(int pin);							// get the digital value of a sensor on the specified pin
-unsigned long systime();						// get the system time
-void set_servo_position(int pin, int position); // set a servo at the specified pin to the specified position
+void example_drive(float straight); // example motor control function with a float input that executes but not returning
 
 // *** Variable Definitions *** //
 
@@ -79,12 +59,8 @@ void set_servo_position(int pin, int position); // set a servo at the specified
 
 int example_integer_variable = 100; // this example variable stores an integer value that is declared globally
 
-// global variables to store all current sensor values accessible to all functions and updated by the "read_sensors" function
-int right_photo_value, left_photo_value, right_ir_value, left_ir_value, front_bump_right_value, front_bump_left_value, back_bump_right_value, back_bump_left_value;
-
-// timer
-int timer_duration = 500;	  // the time in milliseconds to wait between calling action commands, changed by each drive command called by actions
-unsigned long start_time = 0; // store the system time each time we start an action so we can see if our time has elapsed without a blocking delay
+// the current sensor values (right_photo_value, left_ir_value, front_bump_values[0], ...) are global variables of
+// the engine, updated every time read_sensors is called
 
 // *** Function Definitions *** //
 
@@ -96,9 +72,7 @@ unsigned long start_time = 0; // store the system time each time we start an act
 
 int main()
 {
-	enable_servo(LEFT_MOTOR_PIN); // initialize both motors
-	enable_servo(RIGHT_MOTOR_PIN);
-	drive(0.0, 0.0, 1.0); // set our drive speed to zero so we aren't moving at the start
+	start_engine(&robot_pins); // initialize both motors and set our drive speed to zero so we aren't moving at the start
 
 	while (true)
 	{ // infinite loop (true is always true!)
@@ -114,55 +88,10 @@ int main()
 	return 0;
 }
 
-//========================================//
-//===============PERCEPTION===============//
-//========================================//
-
-/**
-This function is called once per loop, and reads all the sensor values and sets the appropriate global variables defined above.
-**/
-
-void read_sensors()
-{
-	left_photo_value = analog_et(LEFT_PHOTO_PIN);	// read the photo sensor at the LEFT_PHOTO_PIN; *** NOTE: greater value means less light ***
-	right_photo_value = analog_et(RIGHT_PHOTO_PIN); // read the photo sensor at the RIGHT_PHOTO_PIN; *** NOTE: greater value means less light ***
-	left_ir_value = analog_et(LEFT_IR_PIN);			// read the sensor for the left IR at LEFT_IR_PIN
-	right_ir_value = analog_et(RIGHT_IR_PIN);		// read the sensor for the right IR at RIGHT_IR_PIN
-
-	front_bump_right_value = digital(FRONT_BUMP_RIGHT_PIN); // read the bumper at FRONT_BUMP_RIGHT_PIN
-	front_bump_left_value = digital(FRONT_BUMP_LEFT_PIN);	// read the bumper at FRONT_BUMP_LEFT_PIN
-	back_bump_right_value = digital(BACK_BUMP_RIGHT_PIN);	// read the bumper at BACK_BUMP_RIGHT_PIN
-	back_bump_left_value = digital(BACK_BUMP_LEFT_PIN);		// read the bumper at BACK_BUMP_LEFT_PIN'
-}
-
 //====================================//
 //===============ACTION===============//
 //====================================//
 
-/*
-The drive function takes the left and right motor speeds and a delay time amount as inputs and triggers the wheels to drive.  
-
-Inputs:
-	[left] The left wheel speed, between -1.0 and 1.0
-	[right] The right wheel speed, between -1.0 and 1.0
-	[delay_seconds] The delay time in seconds (0 to MAX_FLOAT)
-*/
-
-void drive(float left, float right, float delay_seconds)
-{
-	// 850 is full motor speed clockwise, 1250 is full motor speed counterclockwise
-	// Servo is stopped from ~1044 to 1055
-
-	float left_speed = map(left, -1.0, 1.0, 850.0, 1250.0); // call the map function to map our speed (set between -1 and 1) to the appropriate range of motor values
-	float right_speed = map(right, -1.0, 1.0, 1250.0, 850.0);
-
-	timer_duration = (int)(delay_seconds * 1000.0); // multiply our desired time in seconds by 1000 to get milliseconds and update this global variable
-	start_time = systime();							// update our start time to reflect the time we start driving (in ms)
-
-	set_servo_position(LEFT_MOTOR_PIN, left_speed); 
-	set_servo_position(RIGHT_MOTOR_PIN, right_speed); // set the servos to run at the mapped speed
-}
-
 /*
 This is an example of a function, it checks if the input value is greater than three.  If it is, it returns the integer 3 and drives straight.
 
@@ -182,37 +111,3 @@ int example_do_something(float foo)
 	else
 		return 0;
 }
-
-//=====================================//
-//===============HELPERS===============//
-//=====================================//
-
-/*
-Checks if the timer has elapsed.
-
-Returns true if the global variable start time + the timer duration is greater than the system clock time (in milliseconds)
-*/
-
-bool timer_elapsed()
-{
-	return (systime() > (start_time + timer_duration)); // return true if the current time is greater than our start time plus timer duration
-}
-
-
-/*
-Map a value from an input range to a new value in a new range.
-
-Inputs:
-	[value] the starting number to remap
-	[start_range_low] the low value of the initial bounds
-	[start_range_high] the high value of the initial bounds
-	[target_range_low] the low value of the target bounds
-	[target_range_high] the high value of the target bounds
-
-Returns the remapped value as a float
-*/
-
-float map(float value, float start_range_low, float start_range_high, float target_range_low, float target_range_high)
-{
-	return target_range_low + ((value - start_range_low) / (start_range_high - start_range_low)) * (target_range_high - target_range_low);
-}
@@ -0,0 +1,293 @@
+/*
+Vassar Cognitive Science - Robot Ethology session log analyzer
+
+Turns a day's worth of session logs (see RE_Log.h) into behavior statistics, written as CSV files for a spreadsheet:
+
+	PREFIX_occupancy.csv	how long the robot spent in each behavior, in total and as a fraction of the time
+	PREFIX_transitions.csv	how often each behavior (row) was followed by each other behavior (column)
+	PREFIX_bumps.csv		how often the front and back bumpers were hit, in total and per hour
+	PREFIX_durations.csv	how long each bout of a behavior lasted: count, mean, percentiles and a histogram
+
+A bout is a stretch of time in one behavior, from the decision that started it to the one that replaced it; the last
+bout of each log ends with the log.  The percentiles are read off the histogram, so each is the upper edge of its
+50 ms bin, capped at the longest bout; one that falls past the last bin (10 seconds) is the longest bout.  The logs are memory-mapped and shared out over one thread per core, each adding
+into its own totals, which are added together at the end.
+
+	gcc -O2 -pthread -IEngine Tools/re_analyze.c Engine/RE_LogReader.c -o re_analyze
+	./re_analyze day1 session_*.relog
+*/
+
+#include "RE_Log.h"
+#include "RE_Behaviors.h"
+#include <stdatomic.h> // library for handing out the logs to the threads
+#include <pthread.h>   // library for the worker threads
+#include <fcntl.h>	   // library for opening the logs
+#include <sys/mman.h>  // library for mapping the logs into memory
+#include <sys/stat.h>  // library for the size of a log
+#include <unistd.h>	   // library for closing the logs and counting the cores
+#include <time.h>	   // library for timing the analysis
+
+#define MAX_THREADS 64
+#define BEHAVIOR_SLOTS (BEHAVIOR_TYPE_COUNT + 1) // slot 0 is stopped (NO_BEHAVIOR_TYPE), slot type + 1 is each behavior
+#define DURATION_BIN_MS 50						 // the histogram of bout durations counts in bins this wide
+#define DURATION_BINS 200						 // so it reaches 10 seconds, with the last bin holding everything longer
+
+// The behavior titles, without linking the whole engine
+#define BEHAVIOR_TITLE(name, title, fires, mirrored, left, right, seconds) [name##_TYPE + 1] = title,
+const char* slot_titles[BEHAVIOR_SLOTS] = {[0] = "STOP", RE_BEHAVIORS(BEHAVIOR_TITLE)};
+
+/*
+Everything we count, for one thread's share of the logs or for all of them.
+*/
+typedef struct totals
+{
+	unsigned long logs, unreadable;
+	unsigned long long frames, milliseconds;
+	unsigned long long occupancy_ms[BEHAVIOR_SLOTS];
+	unsigned long transitions[BEHAVIOR_SLOTS][BEHAVIOR_SLOTS]; // [from][to]
+	unsigned long front_bumps, back_bumps;					   // presses: a mask going from nothing pressed to something pressed
+	unsigned long bouts[BEHAVIOR_SLOTS];
+	unsigned long long bout_ms[BEHAVIOR_SLOTS];
+	unsigned long longest_bout_ms[BEHAVIOR_SLOTS];
+	unsigned long duration_bins[BEHAVIOR_SLOTS][DURATION_BINS];
+} totals;
+
+char** log_paths;
+int log_count;
+atomic_int next_log = 0;
+totals thread_totals[MAX_THREADS];
+
+/* THE SLOT OF A BEHAVIOR TYPE */
+int slot(int behavior)
+{
+	return (behavior >= 0 && behavior < BEHAVIOR_TYPE_COUNT) ? behavior + 1 : 0;
+}
+
+void count_bout(totals* sums, int behavior, unsigned long milliseconds)
+{
+	int s = slot(behavior);
+	unsigned long bin = milliseconds / DURATION_BIN_MS;
+	sums->bouts[s]++;
+	sums->bout_ms[s] += milliseconds;
+	if (milliseconds > sums->longest_bout_ms[s])
+		sums->longest_bout_ms[s] = milliseconds;
+	sums->duration_bins[s][bin < DURATION_BINS ? bin : DURATION_BINS - 1]++;
+}
+
+/* ADD ONE LOG TO A THREAD'S TOTALS */
+void analyze_log(const unsigned char* data, size_t size, totals* sums)
+{
+	log_reader reader;
+	if (!open_log_reader(&reader, data, size))
+	{
+		sums->unreadable++;
+		return;
+	}
+	sums->logs++;
+
+	log_state frame, last;
+	unsigned long frames, elapsed_ms;
+	if (!next_log_span(&reader, &last, &frames, &elapsed_ms))
+		return; // an empty log
+	unsigned long bout_start = last.time;
+	sums->frames++;
+
+	while (next_log_span(&reader, &frame, &frames, &elapsed_ms))
+	{
+		sums->frames += frames;
+		sums->milliseconds += elapsed_ms;
+		sums->occupancy_ms[slot(last.behavior)] += elapsed_ms; // the time since the last frame was spent in its behavior
+
+		if (frame.behavior != last.behavior)
+		{
+			sums->transitions[slot(last.behavior)][slot(frame.behavior)]++;
+			count_bout(sums, last.behavior, frame.time - bout_start);
+			bout_start = frame.time;
+		}
+		if (last.front_bumps == 0 && frame.front_bumps != 0)
+			sums->front_bumps++;
+		if (last.back_bumps == 0 && frame.back_bumps != 0)
+			sums->back_bumps++;
+		last = frame;
+	}
+	count_bout(sums, last.behavior, last.time - bout_start);
+}
+
+/* TAKE LOGS UNTIL THERE ARE NONE LEFT */
+void* run_worker(void* argument)
+{
+	totals* sums = argument;
+	int index;
+	while ((index = atomic_fetch_add(&next_log, 1)) < log_count)
+	{
+		int file = open(log_paths[index], O_RDONLY);
+		struct stat status;
+		if (file < 0 || fstat(file, &status) != 0 || status.st_size == 0)
+		{
+			if (file >= 0)
+				close(file);
+			sums->unreadable++;
+			continue;
+		}
+		void* data = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		if (data == MAP_FAILED)
+		{
+			sums->unreadable++;
+			continue;
+		}
+		madvise(data, (size_t)status.st_size, MADV_SEQUENTIAL);
+		analyze_log(data, (size_t)status.st_size, sums);
+		munmap(data, (size_t)status.st_size);
+	}
+	return NULL;
+}
+
+/* ADD ONE THREAD'S TOTALS TO THE OVERALL ONES: EVERY FIELD IS A COUNT THAT ADDS UP, EXCEPT THE LONGEST BOUTS */
+void merge_totals(totals* all, const totals* part)
+{
+	int from, to, bin;
+	all->logs += part->logs;
+	all->unreadable += part->unreadable;
+	all->frames += part->frames;
+	all->milliseconds += part->milliseconds;
+	all->front_bumps += part->front_bumps;
+	all->back_bumps += part->back_bumps;
+	for (from = 0; from < BEHAVIOR_SLOTS; from++)
+	{
+		all->occupancy_ms[from] += part->occupancy_ms[from];
+		all->bouts[from] += part->bouts[from];
+		all->bout_ms[from] += part->bout_ms[from];
+		if (part->longest_bout_ms[from] > all->longest_bout_ms[from])
+			all->longest_bout_ms[from] = part->longest_bout_ms[from];
+		for (to = 0; to < BEHAVIOR_SLOTS; to++)
+			all->transitions[from][to] += part->transitions[from][to];
+		for (bin = 0; bin < DURATION_BINS; bin++)
+			all->duration_bins[from][bin] += part->duration_bins[from][bin];
+	}
+}
+
+/* THE BOUT DURATION BELOW WHICH A FRACTION OF THE BOUTS FALL: THE UPPER EDGE OF ITS BIN, BUT NEVER MORE THAN THE
+LONGEST BOUT, WHICH IS ALSO THE ANSWER IN THE LAST BIN (IT HAS NO UPPER EDGE) */
+unsigned long percentile_ms(const totals* all, int s, double fraction)
+{
+	unsigned long wanted = (unsigned long)(fraction * all->bouts[s]);
+	unsigned long seen = 0;
+	int bin;
+	for (bin = 0; bin < DURATION_BINS - 1; bin++)
+	{
+		seen += all->duration_bins[s][bin];
+		if (seen > wanted)
+		{
+			unsigned long edge = (unsigned long)(bin + 1) * DURATION_BIN_MS;
+			return (edge < all->longest_bout_ms[s]) ? edge : all->longest_bout_ms[s];
+		}
+	}
+	return all->longest_bout_ms[s];
+}
+
+/* OPEN PREFIX_NAME.csv FOR WRITING */
+FILE* open_csv(const char* prefix, const char* name)
+{
+	char path[512];
+	snprintf(path, sizeof(path), "%s_%s.csv", prefix, name);
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+		perror(path);
+	return file;
+}
+
+void write_csv_files(const char* prefix, const totals* all)
+{
+	int from, to, bin;
+	double hours = all->milliseconds / 3600000.0;
+	FILE* file;
+
+	if ((file = open_csv(prefix, "occupancy")) != NULL)
+	{
+		fprintf(file, "behavior,milliseconds,fraction\n");
+		for (from = 0; from < BEHAVIOR_SLOTS; from++)
+			fprintf(file, "%s,%llu,%.6f\n", slot_titles[from], all->occupancy_ms[from],
+					all->milliseconds > 0 ? (double)all->occupancy_ms[from] / all->milliseconds : 0.0);
+		fclose(file);
+	}
+
+	if ((file = open_csv(prefix, "transitions")) != NULL)
+	{
+		fprintf(file, "from\\to");
+		for (to = 0; to < BEHAVIOR_SLOTS; to++)
+			fprintf(file, ",%s", slot_titles[to]);
+		fprintf(file, "\n");
+		for (from = 0; from < BEHAVIOR_SLOTS; from++)
+		{
+			fprintf(file, "%s", slot_titles[from]);
+			for (to = 0; to < BEHAVIOR_SLOTS; to++)
+				fprintf(file, ",%lu", all->transitions[from][to]);
+			fprintf(file, "\n");
+		}
+		fclose(file);
+	}
+
+	if ((file = open_csv(prefix, "bumps")) != NULL)
+	{
+		fprintf(file, "bumper,presses,per_hour\n");
+		fprintf(file, "front,%lu,%.2f\n", all->front_bumps, hours > 0 ? all->front_bumps / hours : 0.0);
+		fprintf(file, "back,%lu,%.2f\n", all->back_bumps, hours > 0 ? all->back_bumps / hours : 0.0);
+		fclose(file);
+	}
+
+	if ((file = open_csv(prefix, "durations")) != NULL)
+	{
+		fprintf(file, "behavior,bouts,mean_ms,p50_ms,p90_ms,p99_ms,max_ms");
+		for (bin = 0; bin < DURATION_BINS; bin++)
+			fprintf(file, ",%s%d", bin == DURATION_BINS - 1 ? ">=" : "<", (bin + (bin < DURATION_BINS - 1)) * DURATION_BIN_MS);
+		fprintf(file, "\n");
+		for (from = 0; from < BEHAVIOR_SLOTS; from++)
+		{
+			fprintf(file, "%s,%lu,%.1f,%lu,%lu,%lu,%lu", slot_titles[from], all->bouts[from],
+					all->bouts[from] > 0 ? (double)all->bout_ms[from] / all->bouts[from] : 0.0,
+					percentile_ms(all, from, 0.5), percentile_ms(all, from, 0.9), percentile_ms(all, from, 0.99), all->longest_bout_ms[from]);
+			for (bin = 0; bin < DURATION_BINS; bin++)
+				fprintf(file, ",%lu", all->duration_bins[from][bin]);
+			fprintf(file, "\n");
+		}
+		fclose(file);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		printf("usage: %s OUTPUT_PREFIX LOG...\n", argv[0]);
+		return 1;
+	}
+	log_paths = argv + 2;
+	log_count = argc - 2;
+
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	int thread_count = (cores < 1) ? 1 : (cores > MAX_THREADS) ? MAX_THREADS : (int)cores;
+	if (thread_count > log_count)
+		thread_count = log_count;
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pthread_t threads[MAX_THREADS];
+	int i;
+	for (i = 0; i < thread_count; i++)
+		pthread_create(&threads[i], NULL, run_worker, &thread_totals[i]);
+
+	static totals all; // too big for the stack
+	for (i = 0; i < thread_count; i++)
+	{
+		pthread_join(threads[i], NULL);
+		merge_totals(&all, &thread_totals[i]);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	write_csv_files(argv[1], &all);
+	printf("%lu logs (%lu unreadable), %llu frames, %.2f hours of running, in %.3f s on %d threads\n",
+		   all.logs, all.unreadable, all.frames, all.milliseconds / 3600000.0,
+		   (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9, thread_count);
+	return 0;
+}
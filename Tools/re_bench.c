@@ -0,0 +1,112 @@
+/*
+Vassar Cognitive Science - Robot Ethology decision benchmark
+
+Compares the three ways the engine can pick a behavior for the default hierarchy (the one RE_Plain.c runs):
+
+	walk	plan_hierarchy(): go down subsumption_hierarchy, checking is_active and dispatching on the type
+	table	the decision table compiled from that hierarchy (what the GUI program uses)
+	fixed	a decision function with the hierarchy compiled in by DEFINE_FIXED_DECIDER
+
+It first checks that all three agree for every combination of condition bits, then times each one over the same
+stream of random conditions.  This runs on a desktop computer, not on the robot:
+
+	gcc -O2 -IEngine Tools/re_bench.c Engine/RE_Engine.c Engine/RE_Filter.c Engine/RE_Sampling.c Engine/RE_Calibration.c -o re_bench
+	./re_bench [decisions]
+*/
+
+#include "RE_Engine.h"
+#include "RE_Behaviors.h"
+#include <time.h> // library for timing on the desktop
+
+#define DEFAULT_DECISIONS 20000000
+#define CONDITION_STREAM_LENGTH 4096 // a power of two, so the stream can be indexed with a mask
+
+#define BENCH_HIERARCHY(STEP) \
+	STEP(ESCAPE_F)            \
+	STEP(ESCAPE_B)            \
+	STEP(AVOID)               \
+	STEP(SEEK_LIGHT)          \
+	STEP(CRUISE_S)
+
+DEFINE_FIXED_DECIDER(decide_fixed, BENCH_HIERARCHY)
+
+// The engine refers to these library functions, but the benchmark never reads sensors or drives
+void enable_servo(int pin) { (void)pin; }
+void disable_servos() {}
+int analog_et(int pin) { return pin * 0; }
+int digital(int pin) { return pin * 0; }
+unsigned long systime() { return 0; }
+void set_servo_position(int pin, int position) { (void)pin, (void)position; }
+
+int condition_stream[CONDITION_STREAM_LENGTH]; // random condition bits, shared by every method
+
+/* MONOTONIC TIME IN NANOSECONDS */
+double now_ns()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/* TIME ONE METHOD (0 = walk, 1 = table, 2 = fixed) AND RETURN NANOSECONDS PER DECISION */
+double time_method(int method, long decisions, float* checksum)
+{
+	decision result;
+	float sum = 0;
+	long i;
+	double start = now_ns();
+	for (i = 0; i < decisions; i++)
+	{
+		int conditions = condition_stream[i & (CONDITION_STREAM_LENGTH - 1)];
+		if (method == 0)
+			plan_hierarchy(conditions, &result);
+		else if (method == 1)
+			result = decision_table[conditions];
+		else
+			decide_fixed(conditions, &result);
+		sum += result.params.left + result.type; // use every result so the compiler can't skip the work
+	}
+	double elapsed = now_ns() - start;
+	*checksum = sum;
+	return elapsed / decisions;
+}
+
+int main(int argc, char** argv)
+{
+	long decisions = (argc > 1) ? atol(argv[1]) : DEFAULT_DECISIONS;
+	if (decisions <= 0)
+		decisions = DEFAULT_DECISIONS;
+
+	compile_decision_table();
+
+	int conditions;
+	for (conditions = 0; conditions < (1 << CONDITION_BITS); conditions++)
+	{ // all three methods must pick the same behavior with the same speeds
+		decision walked, fixed;
+		plan_hierarchy(conditions, &walked);
+		decide_fixed(conditions, &fixed);
+		const decision* looked_up = &decision_table[conditions];
+		if (walked.type != fixed.type || walked.type != looked_up->type || walked.params.left != fixed.params.left ||
+			walked.params.right != fixed.params.right || walked.params.left != looked_up->params.left)
+		{
+			printf("methods disagree for conditions 0x%02x\n", conditions);
+			return 1;
+		}
+	}
+
+	srand(1);
+	int i;
+	for (i = 0; i < CONDITION_STREAM_LENGTH; i++)
+		condition_stream[i] = rand() & ((1 << CONDITION_BITS) - 1);
+
+	const char* names[] = {"walk", "table", "fixed"};
+	float checksums[3];
+	int method;
+	printf("%ld decisions per method\n", decisions);
+	for (method = 0; method < 3; method++)
+	{
+		double ns = time_method(method, decisions, &checksums[method]);
+		printf("%-6s %7.2f ns/decision  (checksum %.0f)\n", names[method], ns, checksums[method]);
+	}
+	return 0;
+}
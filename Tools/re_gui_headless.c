@@ -0,0 +1,317 @@
+/*
+Vassar Cognitive Science - Robot Ethology GUI without the robot
+
+Runs the GUI program (GUI/RE_GUI.c) on a desktop computer: the buttons are pressed by a script instead of a person,
+the robot and its sensors are the simulator's (see re_sim.h), nothing is drawn, and the random numbers that shuffle
+the hierarchy start from a fixed seed.  Time is simulated, so a script comes out the same every time it is run.
+
+A script is a text file with one button press per line: the simulated time in milliseconds, the button (SIDE, A, B,
+C, X, Y or Z) and, if it isn't the usual 50, how many milliseconds the button is held.  Lines starting with # are
+comments.  The session runs until a second after the last press, or until a line with the time and END.
+
+	# open the gui, activate the top two behaviors, run them for a minute
+	1000 SIDE
+	1500 A
+	1800 Z
+	2000 A
+	2500 SIDE
+	62500 END
+
+For each script it prints how much work the GUI did: passes of the main loop, button events dispatched, sorts of the
+hierarchy, screens drawn, button labels set, decisions made, and how many milliseconds after the GUI was last closed
+the first decision came (-1 if none did).  Given a file of those lines from an earlier run (-b), it also says which
+of the dispatches, sorts, screens and labels went up and exits with 1 if any did, so the check can run after every
+change.  The other counts follow the script's timing rather than the work each press makes, so they are only
+printed.  A baseline written with different counts is refused.
+
+	gcc -O2 -DRE_GUI_HEADLESS -IEngine -IGUI -ITools Tools/re_gui_headless.c GUI/RE_GUI.c Tools/re_sim.c Engine/RE_Engine.c Engine/RE_Filter.c Engine/RE_Sampling.c Engine/RE_Calibration.c Engine/RE_Config.c Engine/RE_Display.c Engine/RE_Telemetry.c Engine/RE_Log.c Engine/RE_Trace.c -pthread -lm -o re_gui_headless
+	./re_gui_headless -s 7 gui_*.txt > baseline.txt
+	./re_gui_headless -s 7 -b baseline.txt gui_*.txt
+
+Each script runs in its own process, so it starts from a freshly started program like the robot does.  The GUI
+still writes its decision table and sampling report into the current directory when it starts and stops operating.
+With -c, each script starts by loading a configuration file (see RE_Config.h) the way the robot loads
+robot_ethology.cfg, e.g. to send telemetry to Tools/re_telemetry.c.
+*/
+
+#include "re_sim.h"
+#include "RE_Display.h"
+#include "RE_GUI.h"
+#include "RE_Config.h"
+#include <string.h>	  // library for comparing names
+#include <unistd.h>	  // library for fork
+#include <sys/wait.h> // library for waiting for a script's process
+
+#define MAX_PRESSES 4096
+#define HOLD_MS 50		  // how long a button is held when the script doesn't say
+#define RUN_ON_MS 1000	  // how long a session runs after its last press, without an END line
+#define COUNT_FIELDS 7
+#define COUNT_HEADER "# script passes dispatches sorts renders labels decisions first_decision_ms" // the first line of the output
+
+typedef struct press
+{
+	unsigned long time;
+	int button; // index into button_names
+	unsigned long hold_ms;
+} press;
+
+const char* button_names[] = {"SIDE", "A", "B", "C", "X", "Y", "Z"};
+#define BUTTON_NAMES (sizeof(button_names) / sizeof(button_names[0]))
+
+const char* count_names[COUNT_FIELDS] = {"passes", "dispatches", "sorts", "renders", "labels", "decisions", "first_decision_ms"};
+const bool count_compared[COUNT_FIELDS] = {false, true, true, true, true, false, false}; // the counts checked against a baseline
+
+press presses[MAX_PRESSES];
+int press_count = 0;
+const char* config_path = NULL; // the configuration file given with -c, if any
+unsigned long labels_set = 0; // calls to the set_*_button_text functions
+
+//===============THE SCRIPT===============//
+
+/* READ A SCRIPT, RETURNS THE TIME THE SESSION ENDS OR 0 IF THE SCRIPT CAN'T BE READ */
+unsigned long read_script(const char* path)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL)
+	{
+		perror(path);
+		return 0;
+	}
+	char line[128], name[16];
+	unsigned long time, hold_ms, end = 0;
+	int line_number = 0, fields;
+	press_count = 0;
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		line_number++;
+		if (line[0] == '#' || (fields = sscanf(line, "%lu %15s %lu", &time, name, &hold_ms)) < 2)
+			continue; // a comment or a blank line
+		if (strcmp(name, "END") == 0)
+		{
+			end = time;
+			break;
+		}
+		size_t button;
+		for (button = 0; button < BUTTON_NAMES && strcmp(name, button_names[button]) != 0; button++)
+			;
+		if (button == BUTTON_NAMES || press_count == MAX_PRESSES)
+		{
+			printf("%s:%d: %s\n", path, line_number, button == BUTTON_NAMES ? "no such button" : "too many presses");
+			fclose(file);
+			return 0;
+		}
+		presses[press_count].time = time;
+		presses[press_count].button = (int)button;
+		presses[press_count].hold_ms = (fields == 3) ? hold_ms : HOLD_MS;
+		press_count++;
+		if (time + RUN_ON_MS > end)
+			end = time + RUN_ON_MS;
+	}
+	fclose(file);
+	return (end > 0) ? end : RUN_ON_MS;
+}
+
+/* 1 WHILE THE SCRIPT HOLDS A BUTTON DOWN AT THE CURRENT SIMULATED TIME */
+int scripted_button(int button)
+{
+	unsigned long now = systime();
+	int i;
+	for (i = 0; i < press_count; i++)
+	{
+		if (presses[i].button == button && now >= presses[i].time && now < presses[i].time + presses[i].hold_ms)
+			return 1;
+	}
+	return 0;
+}
+
+//===============LIBRARY FUNCTIONS===============//
+
+int side_button() { return scripted_button(0); }
+int a_button() { return scripted_button(1); }
+int b_button() { return scripted_button(2); }
+int c_button() { return scripted_button(3); }
+int x_button() { return scripted_button(4); }
+int y_button() { return scripted_button(5); }
+int z_button() { return scripted_button(6); }
+
+int any_button()
+{
+	size_t button;
+	for (button = 0; button < BUTTON_NAMES; button++)
+	{
+		if (scripted_button((int)button))
+			return 1;
+	}
+	return 0;
+}
+
+void set_a_button_text(const char* text) { (void)text; labels_set++; }
+void set_b_button_text(const char* text) { (void)text; labels_set++; }
+void set_c_button_text(const char* text) { (void)text; labels_set++; }
+void set_x_button_text(const char* text) { (void)text; labels_set++; }
+void set_y_button_text(const char* text) { (void)text; labels_set++; }
+void set_z_button_text(const char* text) { (void)text; labels_set++; }
+void set_extra_buttons_visible(int visible) { (void)visible; }
+
+// Nothing is drawn: the display thread is never started, so these are only here for the linker
+void console_clear() {}
+void display_printf(int column, int row, const char* format, ...) { (void)column; (void)row; (void)format; }
+
+//===============RUNNING A SCRIPT===============//
+
+/* RUN ONE SCRIPT FROM A FRESH START AND PRINT ITS COUNTS, RETURNS FALSE IF IT CAN'T BE READ */
+bool run_script(const char* path, unsigned long seed)
+{
+	unsigned long end = read_script(path);
+	if (end == 0)
+		return false;
+
+	sim_reset(seed);
+	srand((unsigned int)seed); // randomize_hierarchy shuffles with rand()
+	if (config_path != NULL && load_config(config_path))
+		use_config_hierarchy();
+	start_engine(&robot_pins); // the simulator is wired like the robot
+	while (systime() < end)
+	{
+		run_gui_pass();
+		sim_step(SIM_STEP_MS);
+	}
+
+	printf("%s %lu %lu %lu %lu %lu %lu %ld\n", path, gui_work.passes, gui_work.dispatches, gui_work.sorts,
+		   get_display_stats().submitted, labels_set, gui_work.decisions, startup_ms);
+	return true;
+}
+
+/* SPLIT A LINE OF COUNTS INTO THE SCRIPT NAME AND [counts], RETURNS HOW MANY NUMBERS FOLLOW THE NAME (-1 IF NONE DOES) */
+int read_counts(const char* line, char* name, long* counts)
+{
+	int length, fields = 0;
+	long value;
+	if (sscanf(line, "%511s%n", name, &length) != 1)
+		return -1;
+	for (line += length; sscanf(line, "%ld%n", &value, &length) == 1; line += length)
+	{
+		if (fields < COUNT_FIELDS)
+			counts[fields] = value;
+		fields++;
+	}
+	return fields;
+}
+
+/* CHECK THAT A BASELINE HAS THE COUNTS WE PRINT, RETURNS FALSE (AFTER SAYING WHY) IF IT DOESN'T */
+bool check_baseline(FILE* baseline, const char* path)
+{
+	char line[1024], name[512];
+	long counts[COUNT_FIELDS];
+	int line_number = 1, fields;
+	if (fgets(line, sizeof(line), baseline) == NULL || strncmp(line, COUNT_HEADER, strlen(COUNT_HEADER)) != 0)
+	{
+		fprintf(stderr, "%s: not a baseline of these counts, its first line should start with \"%s\"\n", path, COUNT_HEADER);
+		return false;
+	}
+	while (fgets(line, sizeof(line), baseline) != NULL)
+	{
+		line_number++;
+		if (line[0] != '#' && (fields = read_counts(line, name, counts)) != COUNT_FIELDS)
+		{
+			fprintf(stderr, "%s:%d: %d counts instead of %d\n", path, line_number, (fields < 0) ? 0 : fields, COUNT_FIELDS);
+			return false;
+		}
+	}
+	return true;
+}
+
+/* COMPARE A SCRIPT'S COUNTS WITH ITS LINE IN THE BASELINE, RETURNS THE NUMBER OF COMPARED COUNTS THAT WENT UP */
+int compare_counts(FILE* baseline, const char* line)
+{
+	char name[512], base_name[512], base_line[1024];
+	long counts[COUNT_FIELDS], base[COUNT_FIELDS];
+	if (read_counts(line, name, counts) != COUNT_FIELDS)
+		return 0;
+
+	rewind(baseline);
+	while (fgets(base_line, sizeof(base_line), baseline) != NULL)
+	{
+		if (base_line[0] == '#' || read_counts(base_line, base_name, base) != COUNT_FIELDS || strcmp(name, base_name) != 0)
+			continue;
+		int i, regressions = 0;
+		for (i = 0; i < COUNT_FIELDS; i++)
+		{
+			if (count_compared[i] && counts[i] > base[i])
+			{
+				fprintf(stderr, "%s: %s went from %ld to %ld\n", name, count_names[i], base[i], counts[i]);
+				regressions++;
+			}
+		}
+		return regressions;
+	}
+	fprintf(stderr, "%s: not in the baseline\n", name);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned long seed = 1;
+	FILE* baseline = NULL;
+	int option;
+	while ((option = getopt(argc, argv, "s:b:c:")) != -1)
+	{
+		if (option == 's')
+			seed = strtoul(optarg, NULL, 10);
+		else if (option == 'c')
+			config_path = optarg;
+		else if (option == 'b')
+		{
+			if ((baseline = fopen(optarg, "r")) == NULL)
+			{
+				perror(optarg);
+				return 1;
+			}
+			if (!check_baseline(baseline, optarg))
+				return 1;
+		}
+		else
+			optind = argc; // an unknown option: just print the usage
+	}
+	if (optind >= argc)
+	{
+		printf("usage: %s [-s SEED] [-b BASELINE] [-c CONFIG] SCRIPT...\n", argv[0]);
+		return 1;
+	}
+
+	printf(COUNT_HEADER " (seed %lu)\n", seed);
+	int regressions = 0, failures = 0;
+	int i;
+	for (i = optind; i < argc; i++)
+	{ // the GUI keeps its state in globals, so each script gets a new copy of the program
+		int channel[2];
+		fflush(stdout);
+		if (pipe(channel) != 0)
+			return 1;
+		pid_t child = fork();
+		if (child == 0)
+		{
+			close(channel[0]);
+			dup2(channel[1], STDOUT_FILENO);
+			exit(run_script(argv[i], seed) ? 0 : 1);
+		}
+		close(channel[1]);
+		char line[1024] = "";
+		FILE* output = fdopen(channel[0], "r");
+		while (fgets(line, sizeof(line), output) != NULL)
+		{
+			fputs(line, stdout);
+			if (baseline != NULL)
+				regressions += compare_counts(baseline, line);
+		}
+		fclose(output);
+
+		int status;
+		waitpid(child, &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			failures++;
+	}
+	if (baseline != NULL)
+		fclose(baseline);
+	return (regressions > 0 || failures > 0) ? 1 : 0;
+}
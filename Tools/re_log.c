@@ -0,0 +1,98 @@
+/*
+Vassar Cognitive Science - Robot Ethology session log reader
+
+Prints a session log written with "session_log on" (see RE_Log.h): a summary of the whole session, or the frames
+from a given frame on, which it jumps to through the log's keyframe index instead of reading everything before it
+(a log that was never closed has no index, so for those it reads up to the frame).
+
+	gcc -O2 -IEngine Tools/re_log.c Engine/RE_LogReader.c -o re_log
+	./re_log session_20240910_141503.relog				# how long, how many frames, how big
+	./re_log session_20240910_141503.relog 360000 20	# 20 frames starting at frame 360000 (an hour in)
+*/
+
+#include "RE_Log.h"
+#include "RE_Behaviors.h"
+#include <fcntl.h>	  // library for opening the log
+#include <sys/mman.h> // library for mapping the log into memory
+#include <sys/stat.h> // library for the size of the log
+#include <unistd.h>	  // library for closing the log
+
+// The behavior titles, without linking the whole engine
+#define BEHAVIOR_TITLE(name, title, fires, mirrored, left, right, seconds) [name##_TYPE] = title,
+const char* behavior_titles[BEHAVIOR_TYPE_COUNT] = {RE_BEHAVIORS(BEHAVIOR_TITLE)};
+
+/* MAP A WHOLE FILE INTO MEMORY, RETURNS NULL IF THAT FAILS */
+const unsigned char* map_file(const char* path, size_t* size)
+{
+	int file = open(path, O_RDONLY);
+	struct stat status;
+	if (file < 0 || fstat(file, &status) != 0 || status.st_size == 0)
+		return NULL;
+	void* data = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	*size = (size_t)status.st_size;
+	return (data == MAP_FAILED) ? NULL : data;
+}
+
+void print_frame(const log_state* frame)
+{
+	const char* title = (frame->behavior >= 0 && frame->behavior < BEHAVIOR_TYPE_COUNT) ? behavior_titles[frame->behavior] : "STOP";
+	printf("%9lu %9lu %7d %7d %4d %4d %8ld %8ld %5x %4x %-16s %5d\n", frame->frame, frame->time,
+		   frame->analog[RIGHT_PHOTO_CHANNEL], frame->analog[LEFT_PHOTO_CHANNEL], frame->analog[RIGHT_IR_CHANNEL], frame->analog[LEFT_IR_CHANNEL],
+		   frame->photo_time, frame->ir_time,
+		   frame->front_bumps, frame->back_bumps, title, frame->action_ms);
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2 || argc > 4)
+	{
+		printf("usage: %s LOG [FIRST_FRAME [FRAMES]]\n", argv[0]);
+		return 1;
+	}
+	size_t size;
+	const unsigned char* data = map_file(argv[1], &size);
+	log_reader reader;
+	if (data == NULL || !open_log_reader(&reader, data, size))
+	{
+		printf("%s: not a session log\n", argv[1]);
+		return 1;
+	}
+
+	log_state frame;
+	unsigned long frames, elapsed_ms;
+	if (argc == 2)
+	{
+		unsigned long spans = 0, total = 0, changes = 0;
+		int last_behavior = NO_BEHAVIOR_TYPE;
+		while (next_log_span(&reader, &frame, &frames, &elapsed_ms))
+		{
+			spans++;
+			total += frames;
+			if (frame.behavior != last_behavior)
+				changes++;
+			last_behavior = frame.behavior;
+		}
+		const char* closed = reader.index_position > 0 ? "indexed" : "not closed (no index)";
+		if (total == 0)
+		{
+			printf("%s: no frames\n%zu bytes, %s\n", argv[1], size, closed);
+			return 0;
+		}
+		printf("%s: %lu frames over %.1f minutes, %lu behavior changes\n", argv[1], total, reader.state.time / 60000.0, changes);
+		printf("%zu bytes, %.2f bytes per frame, %lu records, %s\n", size, (double)size / total, spans, closed);
+		return 0;
+	}
+
+	unsigned long first = strtoul(argv[2], NULL, 10);
+	unsigned long count = (argc == 4) ? strtoul(argv[3], NULL, 10) : 20;
+	if (!seek_log_frame(&reader, first))
+	{
+		printf("%s has no frame %lu\n", argv[1], first);
+		return 1;
+	}
+	printf("    frame   time_ms r_photo l_photo r_ir l_ir photo_ms    ir_ms front back behavior         action_ms\n");
+	while (count-- > 0 && next_log_frame(&reader, &frame, &elapsed_ms))
+		print_frame(&frame);
+	return 0;
+}
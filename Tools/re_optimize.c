@@ -0,0 +1,360 @@
+/*
+Vassar Cognitive Science - Robot Ethology parameter optimizer
+
+Searches for thresholds and action speeds that work well, by running the unchanged engine on the simulated robot of
+re_sim.c instead of trying them out by hand on the real one.  Every candidate drives the same set of episodes (the
+same arenas, lights and starting places), scored as
+
+	score = how close to the light the robot stayed (0 to 1) - BUMP_PENALTY for every time it hit something
+
+averaged over the episodes.  The search is a simple cross-entropy method, a cousin of CMA-ES that only keeps a spread
+per parameter: each generation draws candidates around the current mean, keeps the best ELITE_FRACTION, and moves the
+mean and spread towards them.  The first generation is drawn uniformly over the whole range, which makes it a plain
+random search.  The engine's globals aren't shared between threads, so the candidates of a generation are split over
+one worker process per core.
+
+	gcc -O2 -IEngine -ITools Tools/re_optimize.c Tools/re_sim.c Engine/RE_Engine.c Engine/RE_Filter.c \
+		Engine/RE_Sampling.c Engine/RE_Calibration.c -lm -o re_optimize
+	./re_optimize [-g generations] [-p population] [-e episodes] [-s seed] [-o best.cfg] [-r report.csv]
+
+The best candidate is written as a configuration file the robot can load (see RE_Config.h), and every generation's
+scores as a CSV convergence report.  The hierarchy is the compiled-in one: only the behaviors active in it are tuned.
+*/
+
+#include "RE_Engine.h"
+#include "RE_Sampling.h"
+#include "re_sim.h"
+#include <math.h>	  // library for the search distributions
+#include <string.h>	  // library for the parameter names
+#include <unistd.h>	  // library for the worker processes and their pipes
+#include <sys/wait.h> // library for waiting for the workers
+#include <getopt.h>	  // library for the command line options
+
+#define EPISODE_MS 120000	 // each episode runs for two simulated minutes
+#define BUMP_PENALTY 0.02	 // the score lost for each time the robot runs into something
+#define ELITE_FRACTION 0.25	 // the share of each generation the next one is drawn around
+#define SMOOTHING 0.7		 // how far the mean and spread move towards the elite each generation
+#define MIN_SPREAD 0.01		 // the spread never shrinks below this (the parameters are scaled to 0..1)
+#define MAX_PARAMETERS (3 + 3 * BEHAVIOR_TYPE_COUNT)
+#define MAX_POPULATION 1024
+#define MAX_WORKERS 64
+
+/*
+One tuned number: where it lives in the engine and the range it is searched over.  Thresholds are whole numbers.
+*/
+typedef struct parameter
+{
+	char name[48];
+	float low, high;
+	int* threshold;		// set for a threshold
+	float* speed;		// set for an action speed or duration
+} parameter;
+
+parameter parameters[MAX_PARAMETERS];
+int parameter_count = 0;
+
+void add_parameter(const char* name, float low, float high, int* threshold, float* speed)
+{
+	parameter* p = &parameters[parameter_count++];
+	snprintf(p->name, sizeof(p->name), "%s", name);
+	p->low = low;
+	p->high = high;
+	p->threshold = threshold;
+	p->speed = speed;
+}
+
+/* TUNE THE THREE THRESHOLDS AND THE SPEEDS AND DURATION OF EVERY ACTIVE BEHAVIOR */
+void choose_parameters()
+{
+	add_parameter("avoid_threshold", 300, 3500, &avoid_threshold, NULL);
+	add_parameter("approach_threshold", 300, 3500, &approach_threshold, NULL);
+	add_parameter("photo_threshold", 20, 1500, &photo_threshold, NULL);
+	int i;
+	for (i = 0; i < hierarchy_length; i++)
+	{
+		if (!subsumption_hierarchy[i].is_active)
+			continue;
+		behavior_definition* definition = &behavior_registry[subsumption_hierarchy[i].type];
+		char name[48];
+		snprintf(name, sizeof(name), "%s left", definition->title);
+		add_parameter(name, -1, 1, NULL, &definition->params.left);
+		snprintf(name, sizeof(name), "%s right", definition->title);
+		add_parameter(name, -1, 1, NULL, &definition->params.right);
+		snprintf(name, sizeof(name), "%s seconds", definition->title);
+		add_parameter(name, 0.05, 3, NULL, &definition->params.seconds);
+	}
+}
+
+/* PUT A CANDIDATE (EVERY PARAMETER SCALED TO 0..1) INTO THE ENGINE */
+void apply_candidate(const double* candidate)
+{
+	int i;
+	for (i = 0; i < parameter_count; i++)
+	{
+		double value = parameters[i].low + candidate[i] * (parameters[i].high - parameters[i].low);
+		if (parameters[i].threshold != NULL)
+			*parameters[i].threshold = (int)lround(value);
+		else
+			*parameters[i].speed = (float)value;
+	}
+	compile_decision_table();
+}
+
+/* RUN ONE EPISODE WITH WHATEVER IS IN THE ENGINE AND SCORE IT */
+double run_episode(unsigned long seed)
+{
+	sim_reset(seed);
+	reset_sampling_report(0);
+	start_engine(&sim_pins);
+	while (systime() < EPISODE_MS)
+	{
+		read_sensors();
+		if (ready_to_decide())
+			arbitrate();
+		sim_step(SIM_STEP_MS);
+	}
+	sim_score result = sim_result();
+	return result.light - BUMP_PENALTY * result.bumps;
+}
+
+/* THE AVERAGE SCORE OF A CANDIDATE OVER THE EPISODES */
+double score_candidate(const double* candidate, int episodes, unsigned long seed)
+{
+	apply_candidate(candidate);
+	double total = 0;
+	int episode;
+	for (episode = 0; episode < episodes; episode++)
+		total += run_episode(seed * 1000003ul + episode); // every candidate gets the same episodes
+	return total / episodes;
+}
+
+/* SCORE A WHOLE GENERATION, SPLIT OVER ONE WORKER PROCESS PER CORE */
+void score_generation(double candidates[][MAX_PARAMETERS], double* scores, int population, int episodes, unsigned long seed, int workers)
+{
+	int pipes[MAX_WORKERS][2];
+	pid_t children[MAX_WORKERS];
+	int worker, i;
+	for (worker = 0; worker < workers; worker++)
+	{
+		if (pipe(pipes[worker]) != 0 || (children[worker] = fork()) < 0)
+		{
+			perror("starting a worker");
+			exit(1);
+		}
+		if (children[worker] == 0)
+		{ // the worker: every workers-th candidate, sent back as (index, score) pairs
+			close(pipes[worker][0]);
+			for (i = worker; i < population; i += workers)
+			{
+				struct
+				{
+					int index;
+					double score;
+				} result = {i, score_candidate(candidates[i], episodes, seed)};
+				if (write(pipes[worker][1], &result, sizeof(result)) != sizeof(result))
+					_exit(1);
+			}
+			_exit(0);
+		}
+		close(pipes[worker][1]);
+	}
+
+	for (worker = 0; worker < workers; worker++)
+	{
+		struct
+		{
+			int index;
+			double score;
+		} result;
+		while (read(pipes[worker][0], &result, sizeof(result)) == sizeof(result))
+			scores[result.index] = result.score;
+		close(pipes[worker][0]);
+		waitpid(children[worker], NULL, 0);
+	}
+}
+
+/* A NORMALLY DISTRIBUTED RANDOM NUMBER (BOX-MULLER) */
+double random_normal()
+{
+	double u = (rand() + 1.0) / (RAND_MAX + 2.0), v = (rand() + 1.0) / (RAND_MAX + 2.0);
+	return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+/* WRITE A CANDIDATE AS A CONFIGURATION FILE */
+void write_config(const char* path, const double* candidate, double score, int episodes, unsigned long seed)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		perror(path);
+		return;
+	}
+	apply_candidate(candidate);
+	fprintf(file, "# found by re_optimize: score %.4f over %d simulated episodes (seed %lu)\n", score, episodes, seed);
+	fprintf(file, "avoid_threshold %d\napproach_threshold %d\nphoto_threshold %d\n", avoid_threshold, approach_threshold, photo_threshold);
+
+	char name[32];
+	int i;
+	size_t j;
+	fprintf(file, "hierarchy");
+	for (i = 0; i < hierarchy_length; i++)
+	{
+		if (!subsumption_hierarchy[i].is_active)
+			continue;
+		snprintf(name, sizeof(name), "%s", behavior_registry[subsumption_hierarchy[i].type].title);
+		for (j = 0; name[j] != '\0'; j++)
+			name[j] = (name[j] == ' ') ? '_' : name[j]; // the configuration file writes spaces as underscores
+		fprintf(file, " %s", name);
+	}
+	fprintf(file, "\n");
+	for (i = 0; i < hierarchy_length; i++)
+	{
+		if (!subsumption_hierarchy[i].is_active)
+			continue;
+		behavior_definition* definition = &behavior_registry[subsumption_hierarchy[i].type];
+		snprintf(name, sizeof(name), "%s", definition->title);
+		for (j = 0; name[j] != '\0'; j++)
+			name[j] = (name[j] == ' ') ? '_' : name[j];
+		fprintf(file, "action %s %.3f %.3f %.3f\n", name, definition->params.left, definition->params.right, definition->params.seconds);
+	}
+	fclose(file);
+}
+
+int main(int argc, char** argv)
+{
+	int generations = 20, population = 64, episodes = 8;
+	unsigned long seed = 1;
+	const char* config_path = "optimized.cfg";
+	const char* report_path = "optimize_report.csv";
+	int option;
+	while ((option = getopt(argc, argv, "g:p:e:s:o:r:")) != -1)
+	{
+		switch (option)
+		{
+		case 'g':
+			generations = atoi(optarg);
+			break;
+		case 'p':
+			population = atoi(optarg);
+			break;
+		case 'e':
+			episodes = atoi(optarg);
+			break;
+		case 's':
+			seed = strtoul(optarg, NULL, 10);
+			break;
+		case 'o':
+			config_path = optarg;
+			break;
+		case 'r':
+			report_path = optarg;
+			break;
+		default:
+			printf("usage: %s [-g generations] [-p population] [-e episodes] [-s seed] [-o best.cfg] [-r report.csv]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (generations < 1 || population < 4 || population > MAX_POPULATION || episodes < 1)
+	{
+		printf("need at least 1 generation, 4 to %d candidates and 1 episode\n", MAX_POPULATION);
+		return 1;
+	}
+
+	choose_parameters();
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	int workers = (cores < 1) ? 1 : (cores > MAX_WORKERS) ? MAX_WORKERS : (int)cores;
+	int elite = (int)(population * ELITE_FRACTION);
+	if (elite < 2)
+		elite = 2;
+
+	static double candidates[MAX_POPULATION][MAX_PARAMETERS];
+	static double scores[MAX_POPULATION];
+	double mean[MAX_PARAMETERS], spread[MAX_PARAMETERS], best[MAX_PARAMETERS];
+	double best_score = -INFINITY;
+	int generation, i, k;
+
+	// the compiled-in values, as the first candidate and a score to beat
+	for (k = 0; k < parameter_count; k++)
+	{
+		double value = (parameters[k].threshold != NULL) ? *parameters[k].threshold : *parameters[k].speed;
+		best[k] = (value - parameters[k].low) / (parameters[k].high - parameters[k].low);
+		best[k] = fmin(1, fmax(0, best[k]));
+	}
+	double default_score = score_candidate(best, episodes, seed);
+	best_score = default_score;
+
+	FILE* report = fopen(report_path, "w");
+	if (report != NULL)
+		fprintf(report, "generation,best,elite_mean,mean,best_so_far,mean_spread\n");
+	printf("%d parameters, %d candidates x %d episodes per generation, %d workers\n", parameter_count, population, episodes, workers);
+	printf("compiled-in values score %.4f\n", default_score);
+
+	srand((unsigned)seed);
+	for (generation = 0; generation < generations; generation++)
+	{
+		for (i = 0; i < population; i++)
+		{
+			for (k = 0; k < parameter_count; k++)
+			{
+				double x = (generation == 0) ? rand() / (double)RAND_MAX : mean[k] + spread[k] * random_normal();
+				candidates[i][k] = fmin(1, fmax(0, x));
+			}
+		}
+		if (generation == 0)
+			memcpy(candidates[0], best, sizeof(best)); // keep the compiled-in values in the running
+
+		score_generation(candidates, scores, population, episodes, seed, workers);
+
+		// sort the candidates best first (by index, so the candidates themselves stay put)
+		int order[MAX_POPULATION];
+		for (i = 0; i < population; i++)
+			order[i] = i;
+		for (i = 1; i < population; i++)
+		{
+			int j = i, current = order[i];
+			while (j > 0 && scores[order[j - 1]] < scores[current])
+			{
+				order[j] = order[j - 1];
+				j--;
+			}
+			order[j] = current;
+		}
+		if (scores[order[0]] > best_score)
+		{
+			best_score = scores[order[0]];
+			memcpy(best, candidates[order[0]], sizeof(best));
+		}
+
+		double elite_total = 0, total = 0, spread_total = 0;
+		for (i = 0; i < population; i++)
+			total += scores[i];
+		for (i = 0; i < elite; i++)
+			elite_total += scores[order[i]];
+		for (k = 0; k < parameter_count; k++)
+		{ // move towards the mean and spread of the elite
+			double elite_mean = 0, elite_variance = 0;
+			for (i = 0; i < elite; i++)
+				elite_mean += candidates[order[i]][k] / elite;
+			for (i = 0; i < elite; i++)
+				elite_variance += pow(candidates[order[i]][k] - elite_mean, 2) / elite;
+			mean[k] = (generation == 0) ? elite_mean : SMOOTHING * elite_mean + (1 - SMOOTHING) * mean[k];
+			spread[k] = (generation == 0) ? sqrt(elite_variance) : SMOOTHING * sqrt(elite_variance) + (1 - SMOOTHING) * spread[k];
+			spread[k] = fmax(spread[k], MIN_SPREAD);
+			spread_total += spread[k];
+		}
+
+		printf("generation %2d: best %.4f, elite %.4f, mean %.4f, best so far %.4f\n", generation, scores[order[0]],
+			   elite_total / elite, total / population, best_score);
+		if (report != NULL)
+			fprintf(report, "%d,%.5f,%.5f,%.5f,%.5f,%.5f\n", generation, scores[order[0]], elite_total / elite,
+					total / population, best_score, spread_total / parameter_count);
+	}
+	if (report != NULL)
+		fclose(report);
+
+	write_config(config_path, best, best_score, episodes, seed);
+	for (k = 0; k < parameter_count; k++)
+		printf("  %-26s %9.3f\n", parameters[k].name, parameters[k].low + best[k] * (parameters[k].high - parameters[k].low));
+	printf("best score %.4f (compiled-in %.4f), written to %s\n", best_score, default_score, config_path);
+	return 0;
+}
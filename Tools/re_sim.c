@@ -0,0 +1,249 @@
+/*
+Vassar Cognitive Science - Robot Ethology simulator
+
+See re_sim.h for what is simulated and how it is used.
+
+Distances are in millimeters, angles in radians counterclockwise, and the arena runs from (0, 0) to
+(SIM_ARENA_MM, SIM_ARENA_MM).  The random numbers come from our own generator, not rand(), so an episode only depends
+on its seed.
+*/
+
+#include "re_sim.h"
+#include <math.h> // library for the geometry
+
+#define IR_ANGLE 0.35			// the IR sensors look this far to the left and right of straight ahead
+#define PHOTO_ANGLE 0.8			// likewise the photo sensors
+#define IR_RANGE_MM 1000		// farther than this, an IR sensor sees nothing
+#define IR_NOISE 15				// IR readings are off by up to this much
+#define PHOTO_NOISE 20			// likewise photo readings
+#define PHOTO_FALLOFF_MM 600.0	// a photo sensor this far from the light gets half the light it gets next to it
+#define SCORE_FALLOFF_MM 300.0	// the robot this far from the light scores half of what it scores next to it
+#define OBSTACLE_RADIUS_MM 120
+#define SERVO_MIDDLE 1023.5
+
+const pin_map sim_pins = {
+	0, 1, 2, 3, // right IR, left IR, right photo, left photo (analog)
+	{2, 3}, 2,	// front bumpers (digital)
+	{0, 1}, 2,	// back bumpers (digital)
+	0, 1,		// right motor, left motor (servos)
+	0, 2047};	// servo positions for full speed backward and forward
+
+typedef struct point
+{
+	double x, y;
+} point;
+
+static unsigned long long random_state;
+static unsigned long sim_time;
+static point robot, light, obstacles[SIM_OBSTACLES];
+static double heading;
+static double left_speed, right_speed; // between -1 and 1, from the servo positions
+static bool front_pressed, back_pressed;
+static double light_sum; // the light score added up over every millisecond
+static sim_score score;
+
+/* A RANDOM NUMBER BETWEEN 0 AND 1 (XORSHIFT) */
+static double random_unit()
+{
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return (random_state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double random_between(double low, double high)
+{
+	return low + (high - low) * random_unit();
+}
+
+/* TRUE IF A CIRCLE OF THE ROBOT'S SIZE AT A POINT OVERLAPS A WALL OR AN OBSTACLE */
+static bool collides(point at)
+{
+	if (at.x < SIM_ROBOT_RADIUS_MM || at.y < SIM_ROBOT_RADIUS_MM || at.x > SIM_ARENA_MM - SIM_ROBOT_RADIUS_MM || at.y > SIM_ARENA_MM - SIM_ROBOT_RADIUS_MM)
+		return true;
+	int i;
+	for (i = 0; i < SIM_OBSTACLES; i++)
+	{
+		if (hypot(at.x - obstacles[i].x, at.y - obstacles[i].y) < OBSTACLE_RADIUS_MM + SIM_ROBOT_RADIUS_MM)
+			return true;
+	}
+	return false;
+}
+
+/* HOW FAR A RAY FROM THE ROBOT'S CENTER GOES BEFORE IT HITS A WALL OR AN OBSTACLE */
+static double ray_distance(double angle)
+{
+	double dx = cos(angle), dy = sin(angle);
+	double nearest = INFINITY;
+	if (dx > 0)
+		nearest = fmin(nearest, (SIM_ARENA_MM - robot.x) / dx);
+	if (dx < 0)
+		nearest = fmin(nearest, -robot.x / dx);
+	if (dy > 0)
+		nearest = fmin(nearest, (SIM_ARENA_MM - robot.y) / dy);
+	if (dy < 0)
+		nearest = fmin(nearest, -robot.y / dy);
+
+	int i;
+	for (i = 0; i < SIM_OBSTACLES; i++)
+	{ // where the ray meets the obstacle's circle, if it does
+		double ox = obstacles[i].x - robot.x, oy = obstacles[i].y - robot.y;
+		double along = ox * dx + oy * dy;
+		double across_squared = ox * ox + oy * oy - along * along;
+		double r_squared = (double)OBSTACLE_RADIUS_MM * OBSTACLE_RADIUS_MM;
+		if (along > 0 && across_squared < r_squared)
+			nearest = fmin(nearest, along - sqrt(r_squared - across_squared));
+	}
+	return nearest;
+}
+
+/* THE IR READING FOR A SENSOR LOOKING AT AN ANGLE FROM STRAIGHT AHEAD */
+static int ir_reading(double offset)
+{
+	double distance = ray_distance(heading + offset) - SIM_ROBOT_RADIUS_MM; // the sensor sits on the robot's edge
+	double reading = (distance > IR_RANGE_MM) ? 0 : 200000.0 / (fmax(distance, 0) + 40); // about 1600 at 85 mm
+	reading += random_between(-IR_NOISE, IR_NOISE);
+	return (int)fmax(0, fmin(4095, reading));
+}
+
+/* THE PHOTO READING FOR A SENSOR LOOKING AT AN ANGLE FROM STRAIGHT AHEAD: LESS MEANS MORE LIGHT */
+static int photo_reading(double offset)
+{
+	double dx = light.x - robot.x, dy = light.y - robot.y;
+	double facing = cos(atan2(dy, dx) - (heading + offset)); // 1 when looking straight at the light
+	double nearness = PHOTO_FALLOFF_MM * PHOTO_FALLOFF_MM / (PHOTO_FALLOFF_MM * PHOTO_FALLOFF_MM + dx * dx + dy * dy);
+	double reading = 3800 - 3400 * fmax(facing, 0) * nearness + random_between(-PHOTO_NOISE, PHOTO_NOISE);
+	return (int)fmax(0, fmin(4095, reading));
+}
+
+/* A RANDOM POINT AT LEAST A MARGIN AWAY FROM THE WALLS */
+static point random_point(double margin)
+{
+	point at = {random_between(margin, SIM_ARENA_MM - margin), random_between(margin, SIM_ARENA_MM - margin)};
+	return at;
+}
+
+void sim_reset(unsigned long seed)
+{
+	random_state = 0x9E3779B97F4A7C15ull ^ ((unsigned long long)seed * 0xBF58476D1CE4E5B9ull);
+	if (random_state == 0)
+		random_state = 1;
+
+	int i;
+	for (i = 0; i < SIM_OBSTACLES; i++)
+		obstacles[i] = random_point(OBSTACLE_RADIUS_MM + 2 * SIM_ROBOT_RADIUS_MM); // leave room to drive around
+	light = random_point(SIM_ROBOT_RADIUS_MM);
+	do
+		robot = random_point(SIM_ROBOT_RADIUS_MM);
+	while (collides(robot));
+	heading = random_between(-M_PI, M_PI);
+
+	stop_motors(); // like a robot switched on again, so start_engine() enables the servos and restarts the timer
+	sim_time = 0;
+	left_speed = 0;
+	right_speed = 0;
+	front_pressed = false;
+	back_pressed = false;
+	light_sum = 0;
+	score.light = 0;
+	score.bumps = 0;
+	score.travelled_mm = 0;
+	score.time = 0;
+}
+
+void sim_step(int milliseconds)
+{
+	double seconds = milliseconds / 1000.0;
+	double left_mm = left_speed * SIM_TOP_SPEED_MM * seconds, right_mm = right_speed * SIM_TOP_SPEED_MM * seconds;
+	double forward = (left_mm + right_mm) / 2;
+	heading = remainder(heading + (right_mm - left_mm) / SIM_WHEEL_BASE_MM, 2 * M_PI); // turning never collides: the robot is round
+
+	point next = {robot.x + forward * cos(heading), robot.y + forward * sin(heading)};
+	bool was_pressed = front_pressed || back_pressed;
+	front_pressed = false;
+	back_pressed = false;
+	if (forward != 0 && collides(next))
+	{ // pushing against something: stay put with the bumper on that side pressed
+		front_pressed = forward > 0;
+		back_pressed = forward < 0;
+		if (!was_pressed)
+			score.bumps++;
+	}
+	else
+	{
+		robot = next;
+		score.travelled_mm += fabs(forward);
+	}
+
+	double dx = light.x - robot.x, dy = light.y - robot.y;
+	light_sum += milliseconds * SCORE_FALLOFF_MM * SCORE_FALLOFF_MM / (SCORE_FALLOFF_MM * SCORE_FALLOFF_MM + dx * dx + dy * dy);
+	sim_time += milliseconds;
+}
+
+sim_score sim_result()
+{
+	score.time = sim_time;
+	score.light = (sim_time > 0) ? light_sum / sim_time : 0;
+	return score;
+}
+
+//===============LIBRARY FUNCTIONS===============//
+
+int analog_et(int pin)
+{
+	if (pin == sim_pins.right_ir)
+		return ir_reading(-IR_ANGLE);
+	if (pin == sim_pins.left_ir)
+		return ir_reading(IR_ANGLE);
+	if (pin == sim_pins.right_photo)
+		return photo_reading(-PHOTO_ANGLE);
+	if (pin == sim_pins.left_photo)
+		return photo_reading(PHOTO_ANGLE);
+	return 0;
+}
+
+int digital(int pin)
+{
+	int i;
+	for (i = 0; i < sim_pins.front_bump_count; i++)
+	{
+		if (pin == sim_pins.front_bumps[i])
+			return front_pressed;
+	}
+	for (i = 0; i < sim_pins.back_bump_count; i++)
+	{
+		if (pin == sim_pins.back_bumps[i])
+			return back_pressed;
+	}
+	return 0;
+}
+
+unsigned long systime()
+{
+	return sim_time;
+}
+
+void set_servo_position(int pin, int position)
+{
+	double speed = (position - SERVO_MIDDLE) / SERVO_MIDDLE;
+	if (pin == sim_pins.left_motor)
+		left_speed = speed;
+	else if (pin == sim_pins.right_motor)
+		right_speed = -speed; // the right wheel is mirrored
+}
+
+void enable_servo(int pin)
+{
+	(void)pin;
+}
+
+void disable_servos()
+{
+	left_speed = 0;
+	right_speed = 0;
+}
+
+void msleep(long milliseconds)
+{
+	sim_step((int)milliseconds);
+}
@@ -0,0 +1,55 @@
+/*
+Vassar Cognitive Science - Robot Ethology simulator
+
+A simple simulated robot for running the engine on a desktop computer: a round robot with two wheels in a square
+arena with a few round obstacles and one light.  It provides the library functions the engine calls (analog_et,
+digital, systime, set_servo_position, enable_servo, disable_servos), so the unchanged engine code reads simulated sensors and drives
+the simulated wheels.  Time is simulated too: systime() only moves when sim_step() is called, so an episode runs as
+fast as the computer can go and comes out the same every time for the same seed.
+
+	sim_reset(seed);
+	start_engine(&sim_pins);
+	while (systime() < 60000)
+	{
+		read_sensors();
+		if (ready_to_decide())
+			arbitrate();
+		sim_step(SIM_STEP_MS);
+	}
+	sim_score score = sim_result();
+
+The sensors are modelled roughly on the real ones: the IR readings rise steeply as a wall or obstacle comes close,
+the photo readings fall (greater means darker) as a sensor faces the light and gets nearer to it, and a bumper is
+pressed while the robot pushes against something on that side.
+*/
+
+#ifndef RE_SIM_H
+#define RE_SIM_H
+
+#include "RE_Engine.h"
+
+#define SIM_STEP_MS 10		   // how far sim_step() usually moves time, about one pass of the robot's main loop
+#define SIM_ARENA_MM 1500	   // the arena is a square this wide
+#define SIM_OBSTACLES 2		   // round obstacles placed in the arena
+#define SIM_ROBOT_RADIUS_MM 90 // the robot is a circle this big
+#define SIM_WHEEL_BASE_MM 150
+#define SIM_TOP_SPEED_MM 200 // wheel speed at full speed, per second
+
+typedef struct sim_score
+{
+	double light;			// how close to the light the robot was, averaged over the episode: 1 on top of it, about 0 far away
+	int bumps;				// times the robot ran into a wall or obstacle
+	double travelled_mm;	// how far the robot's center moved
+	unsigned long time;		// simulated milliseconds
+} sim_score;
+
+extern const pin_map sim_pins; // the wiring of the simulated robot, for start_engine()
+
+void sim_reset(unsigned long seed); // place the robot, the light and the obstacles at random (the same for the same seed) and set the time to 0, with the servos off
+void sim_step(int milliseconds);	// move the robot for a number of milliseconds with the wheel speeds it was given
+sim_score sim_result();				// how the episode went so far
+
+// A library function the engine doesn't use that the simulator also provides
+void msleep(long milliseconds); // moves simulated time, without waiting
+
+#endif
@@ -0,0 +1,109 @@
+/*
+Vassar Cognitive Science - Robot Ethology telemetry receiver
+
+Receives the live frames a robot sends with "telemetry" in its configuration file (see RE_Telemetry.h) and prints
+one line per frame.  Listen on the port or path the robot sends to:
+
+	gcc -O2 -IEngine Tools/re_telemetry.c -o re_telemetry
+	./re_telemetry udp:5005					# frames from a robot on the network
+	./re_telemetry unix:/tmp/re_telemetry	# frames from a program on the same machine
+
+Frames that were dropped on the way (the robot never waits for the network) show up as gaps in the sequence
+numbers, which are counted at the end of each line.
+
+The whole path can be checked on one computer without a robot: the GUI program run by Tools/re_gui_headless.c
+sends its telemetry to localhost when given a configuration that says so.  With gui.txt holding the example script
+from re_gui_headless.c:
+
+	./re_telemetry udp:5005 > check.txt &
+	echo "telemetry udp:127.0.0.1:5005" > check.cfg
+	./re_gui_headless -c check.cfg gui.txt
+	kill %1; wc -l check.txt; tail -1 check.txt
+
+Simulated time runs far faster than the receiver can print, so many frames are lost here, but they must all be
+accounted for: the frames printed (the lines after the header) plus the lost count on the last line come to one
+frame for every 20 ms the GUI was closed, up to the time on that line.  For the example script, which has the GUI
+open from 1000 to 2500 ms, that is (time - 1500) / 20.
+*/
+
+#include "RE_Telemetry.h"
+#include "RE_Behaviors.h"
+#include <string.h>		// library for taking the address apart
+#include <unistd.h>		// library for removing an old Unix socket
+#include <sys/socket.h> // library for the datagram socket
+#include <sys/un.h>		// library for Unix socket addresses
+#include <netinet/in.h> // library for UDP addresses
+
+// The behavior titles, without linking the whole engine
+#define BEHAVIOR_TITLE(name, title, fires, mirrored, left, right, seconds) [name##_TYPE] = title,
+const char* behavior_titles[BEHAVIOR_TYPE_COUNT] = {RE_BEHAVIORS(BEHAVIOR_TITLE)};
+
+/* OPEN A SOCKET BOUND TO "udp:PORT" OR "unix:PATH", RETURNS -1 IF THAT FAILS */
+int open_receiver(const char* where)
+{
+	if (strncmp(where, "unix:", 5) == 0)
+	{
+		struct sockaddr_un address;
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (strlen(where + 5) >= sizeof(address.sun_path))
+			return -1;
+		strcpy(address.sun_path, where + 5);
+		unlink(address.sun_path); // left behind by an earlier run
+
+		int receiver = socket(AF_UNIX, SOCK_DGRAM, 0);
+		if (receiver >= 0 && bind(receiver, (struct sockaddr*)&address, sizeof(address)) != 0)
+			return -1;
+		return receiver;
+	}
+	if (strncmp(where, "udp:", 4) == 0)
+	{
+		struct sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_ANY);
+		address.sin_port = htons((uint16_t)atoi(where + 4));
+
+		int receiver = socket(AF_INET, SOCK_DGRAM, 0);
+		if (receiver >= 0 && bind(receiver, (struct sockaddr*)&address, sizeof(address)) != 0)
+			return -1;
+		return receiver;
+	}
+	return -1;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc != 2)
+	{
+		printf("usage: %s udp:PORT | unix:PATH\n", argv[0]);
+		return 1;
+	}
+	int receiver = open_receiver(argv[1]);
+	if (receiver < 0)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	printf("time_ms  r_photo l_photo r_ir l_ir r_mm l_mm photo_age ir_age front back cond behavior action_ms lost\n");
+	telemetry_frame frame;
+	uint32_t expected = 0;
+	unsigned long lost = 0;
+	while (true)
+	{
+		ssize_t length = recv(receiver, &frame, sizeof(frame), 0);
+		if (length != sizeof(frame) || frame.magic != TELEMETRY_MAGIC)
+			continue; // not one of our frames
+		if (expected != 0 && frame.sequence > expected)
+			lost += frame.sequence - expected;
+		expected = frame.sequence + 1;
+
+		const char* title = (frame.behavior >= 0 && frame.behavior < BEHAVIOR_TYPE_COUNT) ? behavior_titles[frame.behavior] : "STOP";
+		printf("%8u %7d %7d %4d %4d %4d %4d %9u %6u %5x %4x %4.2x %-16s %5u %lu\n", frame.time,
+			   frame.analog[RIGHT_PHOTO_CHANNEL], frame.analog[LEFT_PHOTO_CHANNEL], frame.analog[RIGHT_IR_CHANNEL], frame.analog[LEFT_IR_CHANNEL],
+			   frame.right_ir_mm, frame.left_ir_mm, frame.photo_age_ms, frame.ir_age_ms, frame.front_bumps, frame.back_bumps, frame.conditions, title, frame.action_ms, lost);
+		fflush(stdout);
+	}
+	return 0;
+}